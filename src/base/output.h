@@ -25,6 +25,8 @@
 #include <utility>
 #include <vector>
 
+#include "util/array_view.h"
+
 namespace ethos {
 
 template <class T, class U>
@@ -34,7 +36,7 @@ std::ostream& operator<<(std::ostream& out, const std::pair<T, U>& p)
 }
 
 template <class T>
-std::ostream& operator<<(std::ostream& out, const std::vector<T>& children)
+std::ostream& operator<<(std::ostream& out, const ArrayView<T>& children)
 {
   out << "[";
   bool firstTime = true;
@@ -54,6 +56,12 @@ std::ostream& operator<<(std::ostream& out, const std::vector<T>& children)
   return out;
 }
 
+template <class T>
+std::ostream& operator<<(std::ostream& out, const std::vector<T>& children)
+{
+  return out << ArrayView<T>(children);
+}
+
 /**
  * A utility class to provide (essentially) a "/dev/null" streambuf.
  * If debugging support is compiled in, but debugging for
@@ -0,0 +1,154 @@
+/******************************************************************************
+ * This file is part of the ethos project.
+ *
+ * Copyright (c) 2023-2024 by the authors listed in the file AUTHORS
+ * in the top-level source directory and their institutional affiliations.
+ * All rights reserved.  See the file COPYING in the top-level source
+ * directory for licensing information.
+ ******************************************************************************/
+#include "case_index.h"
+
+namespace ethos {
+
+size_t CaseIndex::KeyHashFunction::operator()(const Key& k) const
+{
+  size_t h = reinterpret_cast<size_t>(k.d_head) >> 4;
+  h ^= static_cast<size_t>(k.d_kind) + 0x9e3779b97f4a7c15ULL + (h << 6)
+       + (h >> 2);
+  h ^= k.d_arity + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2);
+  return h;
+}
+
+CaseIndex::CaseIndex(const Expr& prog) : d_arg(0)
+{
+  size_t ncases = prog.getNumChildren();
+  for (size_t i = 0; i < ncases; i++)
+  {
+    d_all.push_back(i);
+  }
+  if (ncases < 2)
+  {
+    return;
+  }
+  // Cases with the wrong arity are wildcards, so that they are tried (and
+  // reported) in the same order as without the index. Otherwise, pick the
+  // argument position where the most cases are not wildcards.
+  size_t nargs = prog[0][0].getNumChildren();
+  size_t maxCount = 0;
+  Key key;
+  for (size_t j = 1; j < nargs; j++)
+  {
+    size_t count = 0;
+    for (size_t i = 0; i < ncases; i++)
+    {
+      ExprValue* pat = prog[i][0].getValue();
+      if (pat->getNumChildren() == nargs && getKey((*pat)[j], key))
+      {
+        count++;
+      }
+    }
+    if (count > maxCount)
+    {
+      maxCount = count;
+      d_arg = j;
+    }
+  }
+  if (d_arg == 0)
+  {
+    return;
+  }
+  // classify the cases
+  std::vector<std::pair<Key, size_t>> keyed;
+  for (size_t i = 0; i < ncases; i++)
+  {
+    ExprValue* pat = prog[i][0].getValue();
+    if (pat->getNumChildren() == nargs && getKey((*pat)[d_arg], key))
+    {
+      keyed.emplace_back(key, i);
+      d_index[key];
+    }
+    else
+    {
+      d_wildcards.push_back(i);
+    }
+  }
+  // each entry is the cases with that key, merged in order with the wildcards
+  for (std::pair<const Key, std::vector<size_t>>& e : d_index)
+  {
+    std::vector<size_t>& cands = e.second;
+    std::vector<size_t>::iterator itw = d_wildcards.begin();
+    for (const std::pair<Key, size_t>& k : keyed)
+    {
+      if (!(k.first == e.first))
+      {
+        continue;
+      }
+      while (itw != d_wildcards.end() && *itw < k.second)
+      {
+        cands.push_back(*itw);
+        ++itw;
+      }
+      cands.push_back(k.second);
+    }
+    cands.insert(cands.end(), itw, d_wildcards.end());
+  }
+}
+
+CaseIndex::~CaseIndex() {}
+
+const std::vector<size_t>& CaseIndex::getCandidates(
+    const std::vector<ExprValue*>& children) const
+{
+  Key key;
+  if (d_arg == 0 || d_arg >= children.size() || !getKey(children[d_arg], key))
+  {
+    return d_all;
+  }
+  std::unordered_map<Key, std::vector<size_t>, KeyHashFunction>::const_iterator
+      it = d_index.find(key);
+  if (it == d_index.end())
+  {
+    return d_wildcards;
+  }
+  return it->second;
+}
+
+bool CaseIndex::getKey(const ExprValue* e, Key& key)
+{
+  Kind k = e->getKind();
+  if (k == Kind::PARAM)
+  {
+    return false;
+  }
+  key.d_kind = k;
+  if (e->getNumChildren() == 0)
+  {
+    // leaves that are not parameters only match themselves
+    key.d_head = e;
+    key.d_arity = 0;
+    return true;
+  }
+  if (k == Kind::APPLY)
+  {
+    // applications are curried, find the head and the number of arguments
+    size_t arity = 0;
+    while (e->getKind() == Kind::APPLY && e->getNumChildren() == 2)
+    {
+      e = (*e)[0];
+      arity++;
+    }
+    // a non-ground head may match anything
+    if (!e->isGround())
+    {
+      return false;
+    }
+    key.d_head = e;
+    key.d_arity = arity;
+    return true;
+  }
+  key.d_head = nullptr;
+  key.d_arity = e->getNumChildren();
+  return true;
+}
+
+}  // namespace ethos
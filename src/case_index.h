@@ -0,0 +1,79 @@
+/******************************************************************************
+ * This file is part of the ethos project.
+ *
+ * Copyright (c) 2023-2024 by the authors listed in the file AUTHORS
+ * in the top-level source directory and their institutional affiliations.
+ * All rights reserved.  See the file COPYING in the top-level source
+ * directory for licensing information.
+ ******************************************************************************/
+#ifndef CASE_INDEX_H
+#define CASE_INDEX_H
+
+#include <unordered_map>
+#include <vector>
+
+#include "expr.h"
+
+namespace ethos {
+
+/**
+ * An index over the cases of a program, which is used to only try the cases
+ * that may match a given application of the program.
+ *
+ * The index is built over a single argument position of the program, chosen
+ * to be the one where the most cases have a pattern that is not a parameter.
+ * The patterns in this position are classified by a key, consisting of their
+ * kind, their head (for applications and leaves) and their arity. A pattern
+ * can only match terms that have the same key. Patterns that have no key
+ * (e.g. parameters, or applications whose head is not ground) are wildcards,
+ * which are candidates for all terms.
+ */
+class CaseIndex
+{
+ public:
+  /** Build the index for the given program */
+  CaseIndex(const Expr& prog);
+  ~CaseIndex();
+  /**
+   * Get the indices of the cases of the program that may match the
+   * application of the program whose children are given. The indices are in
+   * the order of the cases in the program.
+   */
+  const std::vector<size_t>& getCandidates(
+      const std::vector<ExprValue*>& children) const;
+
+ private:
+  /** The key of a pattern or term */
+  struct Key
+  {
+    Kind d_kind;
+    const ExprValue* d_head;
+    size_t d_arity;
+    bool operator==(const Key& k) const
+    {
+      return d_kind == k.d_kind && d_head == k.d_head && d_arity == k.d_arity;
+    }
+  };
+  /** Hash function for keys */
+  struct KeyHashFunction
+  {
+    size_t operator()(const Key& k) const;
+  };
+  /** Get the key for e, return false if e is a wildcard */
+  static bool getKey(const ExprValue* e, Key& key);
+  /** The argument position we index on, or 0 if we do not index */
+  size_t d_arg;
+  /** All cases */
+  std::vector<size_t> d_all;
+  /** The cases whose pattern is a wildcard in position d_arg */
+  std::vector<size_t> d_wildcards;
+  /**
+   * Maps keys to the cases with that key in position d_arg, merged with the
+   * wildcard cases.
+   */
+  std::unordered_map<Key, std::vector<size_t>, KeyHashFunction> d_index;
+};
+
+}  // namespace ethos
+
+#endif /* CASE_INDEX_H */
@@ -15,7 +15,9 @@
 
 #include "cmd_parser.h"
 
+#include <algorithm>
 #include <iostream>
+#include <iterator>
 #include <ostream>
 #include "base/output.h"
 
@@ -663,10 +665,16 @@ bool CmdParser::parseNextCommand()
     case Token::PROGRAM:
     {
       std::string name = d_eparser.parseSymbol();
+      bool uncached = false;
       if (d_lex.peekToken()==Token::KEYWORD)
       {
         std::string keyword = d_eparser.parseKeyword();
-        if (keyword!="ethos")
+        if (keyword=="uncached")
+        {
+          // the results of this program are never cached across evaluations
+          uncached = true;
+        }
+        else if (keyword!="ethos")
         {
           d_lex.parseError("Unsupported program format");
         }
@@ -709,6 +717,10 @@ bool CmdParser::parseNextCommand()
         // bind the program, temporarily
         d_eparser.bind(name, pvar);
       }
+      if (uncached)
+      {
+        d_state.markProgramUncached(pvar.getValue());
+      }
       Expr program;
       tok = d_lex.peekToken();
       // if RPAREN follows, it is a forward declaration, we do not define the program
@@ -830,10 +842,11 @@ bool CmdParser::parseNextCommand()
         args = d_eparser.parseExprList();
       }
       std::vector<Expr> children;
+      children.reserve(args.size() + premises.size() + 2);
       children.push_back(rule);
-      children.insert(children.end(), args.begin(), args.end());
+      std::move(args.begin(), args.end(), std::back_inserter(children));
       // premises after arguments
-      children.insert(children.end(), premises.begin(), premises.end());
+      std::move(premises.begin(), premises.end(), std::back_inserter(children));
       // the assumption, if pop
       if (isPop)
       {
@@ -841,7 +854,7 @@ bool CmdParser::parseNextCommand()
         {
           d_lex.parseError("Cannot pop at level zero");
         }
-        std::vector<Expr> as = d_state.getCurrentAssumptions();
+        ArrayView<Expr> as = d_state.getCurrentAssumptions();
         Assert (as.size()==1);
         // push the assumption
         children.push_back(as[0]);
@@ -0,0 +1,167 @@
+/******************************************************************************
+ * This file is part of the ethos project.
+ *
+ * Copyright (c) 2023-2024 by the authors listed in the file AUTHORS
+ * in the top-level source directory and their institutional affiliations.
+ * All rights reserved.  See the file COPYING in the top-level source
+ * directory for licensing information.
+ ******************************************************************************/
+#include "compiled_pattern.h"
+
+#include <algorithm>
+
+#include "base/check.h"
+
+namespace ethos {
+
+CompiledPattern::CompiledPattern(const std::vector<ExprValue*>& pats,
+                                 bool groundTerms)
+    : d_npats(pats.size()), d_nregs(static_cast<uint32_t>(pats.size()))
+{
+  // the terms are loaded into the first registers
+  for (size_t i = 0; i < d_npats; i++)
+  {
+    compile(pats[i], static_cast<uint32_t>(i), groundTerms);
+  }
+  d_regs.resize(d_nregs, nullptr);
+  d_binds.resize(d_vars.size(), nullptr);
+}
+
+CompiledPattern::~CompiledPattern() {}
+
+void CompiledPattern::emit(
+    Op op, uint32_t reg, uint32_t arg, ExprValue* e, Kind k, uint32_t dest)
+{
+  Instr i;
+  i.d_op = op;
+  i.d_kind = k;
+  i.d_reg = reg;
+  i.d_dest = dest;
+  i.d_arg = arg;
+  i.d_expr = e;
+  d_code.push_back(i);
+}
+
+void CompiledPattern::compile(ExprValue* p, uint32_t reg, bool groundTerms)
+{
+  if (p->isGround())
+  {
+    // since terms are hash-consed, a ground pattern only matches itself
+    emit(Op::CHECK_EQ, reg, 0, p);
+    return;
+  }
+  if (p->getKind() == Kind::PARAM)
+  {
+    std::vector<ExprValue*>::iterator it =
+        std::find(d_vars.begin(), d_vars.end(), p);
+    uint32_t v = static_cast<uint32_t>(it - d_vars.begin());
+    if (it == d_vars.end())
+    {
+      d_vars.push_back(p);
+    }
+    emit(Op::BIND, reg, v);
+    return;
+  }
+  // a non-ground pattern with children
+  size_t skip = d_code.size();
+  if (!groundTerms)
+  {
+    // if the term is the pattern itself, matching trivially holds
+    emit(Op::SKIP_IF_EQ, reg, 0, p);
+  }
+  size_t nchildren = p->getNumChildren();
+  emit(Op::CHECK_NODE,
+       reg,
+       static_cast<uint32_t>(nchildren),
+       nullptr,
+       p->getKind());
+  for (size_t i = 0; i < nchildren; i++)
+  {
+    uint32_t creg = d_nregs++;
+    emit(Op::LOAD_CHILD, reg, static_cast<uint32_t>(i), nullptr, Kind::NONE, creg);
+    compile((*p)[i], creg, groundTerms);
+  }
+  if (!groundTerms)
+  {
+    d_code[skip].d_arg = static_cast<uint32_t>(d_code.size());
+  }
+}
+
+bool CompiledPattern::run(ExprValue* const* terms, Ctx& ctx) const
+{
+  std::copy(terms, terms + d_npats, d_regs.begin());
+  // initialize the variables from the context
+  size_t nvars = d_vars.size();
+  if (ctx.empty())
+  {
+    std::fill(d_binds.begin(), d_binds.end(), nullptr);
+  }
+  else
+  {
+    for (size_t v = 0; v < nvars; v++)
+    {
+      Ctx::const_iterator it = ctx.find(d_vars[v]);
+      d_binds[v] = it == ctx.end() ? nullptr : it->second;
+    }
+  }
+  size_t pc = 0;
+  size_t ncode = d_code.size();
+  while (pc < ncode)
+  {
+    const Instr& i = d_code[pc];
+    pc++;
+    ExprValue* t = d_regs[i.d_reg];
+    switch (i.d_op)
+    {
+      case Op::CHECK_EQ:
+        if (t != i.d_expr)
+        {
+          return false;
+        }
+        break;
+      case Op::SKIP_IF_EQ:
+        if (t == i.d_expr)
+        {
+          pc = i.d_arg;
+        }
+        break;
+      case Op::CHECK_NODE:
+        if (t->getKind() != i.d_kind || t->getNumChildren() != i.d_arg)
+        {
+          return false;
+        }
+        break;
+      case Op::LOAD_CHILD: d_regs[i.d_dest] = (*t)[i.d_arg]; break;
+      case Op::BIND:
+      {
+        ExprValue* v = d_vars[i.d_arg];
+        // a parameter trivially matches itself
+        if (t == v)
+        {
+          break;
+        }
+        ExprValue*& b = d_binds[i.d_arg];
+        if (b == nullptr)
+        {
+          b = t;
+        }
+        else if (b != t)
+        {
+          return false;
+        }
+      }
+      break;
+    }
+  }
+  // add the new bindings to the context
+  for (size_t v = 0; v < nvars; v++)
+  {
+    if (d_binds[v] != nullptr)
+    {
+      ctx.emplace(d_vars[v], d_binds[v]);
+    }
+  }
+  return true;
+}
+
+}  // namespace ethos
@@ -0,0 +1,102 @@
+/******************************************************************************
+ * This file is part of the ethos project.
+ *
+ * Copyright (c) 2023-2024 by the authors listed in the file AUTHORS
+ * in the top-level source directory and their institutional affiliations.
+ * All rights reserved.  See the file COPYING in the top-level source
+ * directory for licensing information.
+ ******************************************************************************/
+#ifndef COMPILED_PATTERN_H
+#define COMPILED_PATTERN_H
+
+#include <cstdint>
+#include <vector>
+
+#include "expr.h"
+
+namespace ethos {
+
+/**
+ * A list of patterns compiled to a bytecode, which is run by a small virtual
+ * machine to match them against a list of terms.
+ *
+ * Running the bytecode has the same effect as calling TypeChecker::match on
+ * each pattern and its term in order, with a shared context. Subterms of the
+ * terms are loaded into registers, and the parameters of the patterns are
+ * bound in variable registers, which are written to the context on success.
+ */
+class CompiledPattern
+{
+ public:
+  /**
+   * Compile the given patterns.
+   *
+   * @param pats The patterns.
+   * @param groundTerms Whether the terms we match against are always ground,
+   * in which case we can omit checks for whether a non-ground subpattern is
+   * equal to the term.
+   */
+  CompiledPattern(const std::vector<ExprValue*>& pats, bool groundTerms);
+  ~CompiledPattern();
+  /**
+   * Match the patterns against terms, which has the same number of elements
+   * as the patterns. On success, the bindings of the parameters of the
+   * patterns are added to ctx, which may already contain bindings. On
+   * failure, ctx is unchanged.
+   */
+  bool run(ExprValue* const* terms, Ctx& ctx) const;
+  /** The number of instructions */
+  size_t size() const { return d_code.size(); }
+
+ private:
+  /** The opcodes */
+  enum class Op : uint8_t
+  {
+    // fail if register d_reg is not d_expr
+    CHECK_EQ,
+    // jump to d_arg if register d_reg is d_expr
+    SKIP_IF_EQ,
+    // fail if register d_reg does not have kind d_kind and d_arg children
+    CHECK_NODE,
+    // load child d_arg of register d_reg into register d_dest
+    LOAD_CHILD,
+    // bind variable d_arg to register d_reg, or fail if it is already bound
+    // to a different term
+    BIND
+  };
+  /** An instruction */
+  struct Instr
+  {
+    Op d_op;
+    Kind d_kind;
+    uint32_t d_reg;
+    uint32_t d_dest;
+    uint32_t d_arg;
+    ExprValue* d_expr;
+  };
+  /** Compile pattern p, to be matched against register reg */
+  void compile(ExprValue* p, uint32_t reg, bool groundTerms);
+  /** Add an instruction */
+  void emit(Op op,
+            uint32_t reg,
+            uint32_t arg,
+            ExprValue* e = nullptr,
+            Kind k = Kind::NONE,
+            uint32_t dest = 0);
+  /** The code */
+  std::vector<Instr> d_code;
+  /** The parameters of the patterns, which index the variable registers */
+  std::vector<ExprValue*> d_vars;
+  /** The number of patterns */
+  size_t d_npats;
+  /** The number of term registers */
+  uint32_t d_nregs;
+  /** Scratch space for term registers */
+  mutable std::vector<ExprValue*> d_regs;
+  /** Scratch space for variable registers */
+  mutable std::vector<ExprValue*> d_binds;
+};
+
+}  // namespace ethos
+
+#endif /* COMPILED_PATTERN_H */
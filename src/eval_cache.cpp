@@ -0,0 +1,183 @@
+/******************************************************************************
+ * This file is part of the ethos project.
+ *
+ * Copyright (c) 2023-2024 by the authors listed in the file AUTHORS
+ * in the top-level source directory and their institutional affiliations.
+ * All rights reserved.  See the file COPYING in the top-level source
+ * directory for licensing information.
+ ******************************************************************************/
+#include "eval_cache.h"
+
+#include "base/check.h"
+#include "literal.h"
+
+namespace ethos {
+
+EvalCache::EvalCache(size_t& hits, size_t& misses, size_t& evictions)
+    : d_hits(hits),
+      d_misses(misses),
+      d_evictions(evictions),
+      d_limit(0),
+      d_size(0)
+{
+}
+
+EvalCache::~EvalCache() {}
+
+void EvalCache::setLimit(size_t limit)
+{
+  d_limit = limit;
+  while (d_size > d_limit)
+  {
+    evict();
+  }
+}
+
+bool EvalCache::find(const std::vector<ExprValue*>& key, Expr& result)
+{
+  std::unordered_map<std::vector<ExprValue*>,
+                     std::list<Entry>::iterator,
+                     ExprValueVectorHashFunction>::iterator it = d_map.find(key);
+  if (it == d_map.end())
+  {
+    d_misses++;
+    return false;
+  }
+  d_hits++;
+  // move to the front, as it is now the most recently used
+  d_entries.splice(d_entries.begin(), d_entries, it->second);
+  result = it->second->d_result;
+  return true;
+}
+
+void EvalCache::insert(const std::vector<ExprValue*>& key, const Expr& result)
+{
+  std::unordered_map<std::vector<ExprValue*>,
+                     std::list<Entry>::iterator,
+                     ExprValueVectorHashFunction>::iterator it = d_map.find(key);
+  if (it != d_map.end())
+  {
+    Expr& r = it->second->d_result;
+    pin(result.getValue());
+    unpin(r.getValue());
+    r = result;
+    return;
+  }
+  size_t esize = getEntrySize(key.size());
+  if (esize > d_limit)
+  {
+    return;
+  }
+  d_entries.emplace_front();
+  Entry& e = d_entries.front();
+  for (ExprValue* k : key)
+  {
+    e.d_key.emplace_back(k);
+    pin(e.d_key.back().getValue());
+  }
+  e.d_result = result;
+  pin(result.getValue());
+  d_map[key] = d_entries.begin();
+  d_size += esize;
+  // evict until we are within the limit, which may evict this entry if the
+  // terms it keeps alive exceed the limit
+  while (d_size > d_limit)
+  {
+    evict();
+  }
+}
+
+void EvalCache::clear()
+{
+  d_map.clear();
+  d_entries.clear();
+  d_pinned.clear();
+  d_size = 0;
+}
+
+size_t EvalCache::getEntrySize(size_t n)
+{
+  // the entry, its list and map nodes, and the two copies of its key
+  return sizeof(Entry) + 4 * sizeof(void*) + n * (sizeof(Expr) + sizeof(ExprValue*));
+}
+
+size_t EvalCache::getTermSize(const ExprValue* e)
+{
+  return e->asLiteral() != nullptr
+             ? sizeof(Literal)
+             : ExprValue::getAllocSize(e->getNumChildren());
+}
+
+void EvalCache::pin(const ExprValue* e)
+{
+  d_toVisit.push_back(e);
+  while (!d_toVisit.empty())
+  {
+    const ExprValue* cur = d_toVisit.back();
+    d_toVisit.pop_back();
+    // null results and terms that are never deleted are not counted
+    if (cur->isNull() || cur->getFlag(ExprValue::Flag::IS_IMMORTAL))
+    {
+      continue;
+    }
+    Assert(cur->d_id != 0);
+    if (cur->d_id >= d_pinned.size())
+    {
+      d_pinned.resize(cur->d_id + 1, 0);
+    }
+    if (d_pinned[cur->d_id]++ > 0)
+    {
+      // already counted, and so are its children
+      continue;
+    }
+    d_size += getTermSize(cur);
+    ArrayView<ExprValue*> children = cur->getChildren();
+    d_toVisit.insert(d_toVisit.end(), children.begin(), children.end());
+  }
+}
+
+void EvalCache::unpin(const ExprValue* e)
+{
+  d_toVisit.push_back(e);
+  while (!d_toVisit.empty())
+  {
+    const ExprValue* cur = d_toVisit.back();
+    d_toVisit.pop_back();
+    if (cur->isNull() || cur->getFlag(ExprValue::Flag::IS_IMMORTAL))
+    {
+      continue;
+    }
+    Assert(cur->d_id < d_pinned.size() && d_pinned[cur->d_id] > 0);
+    if (--d_pinned[cur->d_id] > 0)
+    {
+      continue;
+    }
+    d_size -= getTermSize(cur);
+    ArrayView<ExprValue*> children = cur->getChildren();
+    d_toVisit.insert(d_toVisit.end(), children.begin(), children.end());
+  }
+}
+
+void EvalCache::evict()
+{
+  Assert(!d_entries.empty());
+  Entry& e = d_entries.back();
+  std::vector<ExprValue*> key;
+  for (const Expr& k : e.d_key)
+  {
+    // nullptr in keys is stored as the null term
+    key.push_back(k.isNull() ? nullptr : k.getValue());
+  }
+  d_map.erase(key);
+  d_size -= getEntrySize(key.size());
+  for (const Expr& k : e.d_key)
+  {
+    unpin(k.getValue());
+  }
+  unpin(e.d_result.getValue());
+  d_evictions++;
+  // note that this may trigger garbage collection of the key and result
+  d_entries.pop_back();
+}
+
+}  // namespace ethos
@@ -0,0 +1,120 @@
+/******************************************************************************
+ * This file is part of the ethos project.
+ *
+ * Copyright (c) 2023-2024 by the authors listed in the file AUTHORS
+ * in the top-level source directory and their institutional affiliations.
+ * All rights reserved.  See the file COPYING in the top-level source
+ * directory for licensing information.
+ ******************************************************************************/
+#ifndef EVAL_CACHE_H
+#define EVAL_CACHE_H
+
+#include <cstdint>
+#include <list>
+#include <unordered_map>
+#include <vector>
+
+#include "expr.h"
+#include "expr_hash.h"
+
+namespace ethos {
+
+/**
+ * A cache from lists of terms to terms, which is used for the results of
+ * evaluating programs on ground arguments and which persists across calls to
+ * TypeChecker::evaluate. It is also used for other caches of State that map
+ * lists of terms to terms, e.g. for overload resolution.
+ *
+ * For programs, entries are keyed on the children of the program
+ * application, i.e. the program followed by its arguments. The keys may
+ * contain nullptr, e.g. as a separator. The keys and results are reference
+ * counted by this cache, so that they are not garbage collected (and their
+ * addresses reused) while cached.
+ *
+ * The cache is bounded by an estimate of the memory used by its entries,
+ * which includes the terms they keep alive. Each term reachable from a key
+ * or result is counted once, no matter how many entries share it, and terms
+ * that are never deleted are not counted. When this estimate exceeds the
+ * limit, the least recently used entries are evicted.
+ */
+class EvalCache
+{
+ public:
+  /**
+   * @param hits The statistic incremented when find succeeds.
+   * @param misses The statistic incremented when find fails.
+   * @param evictions The statistic incremented when an entry is evicted.
+   */
+  EvalCache(size_t& hits, size_t& misses, size_t& evictions);
+  ~EvalCache();
+  /** Set the memory limit, in bytes. A limit of 0 disables the cache. */
+  void setLimit(size_t limit);
+  /** Is this cache enabled? */
+  bool isEnabled() const { return d_limit > 0; }
+  /**
+   * Find the result of evaluating the program application whose children are
+   * key.
+   *
+   * @param key The program followed by its (ground) arguments.
+   * @param result Set to the cached result, which may be null if the
+   * application was found not to evaluate.
+   * @return true if the key was found.
+   */
+  bool find(const std::vector<ExprValue*>& key, Expr& result);
+  /** Store that the program application with children key evaluates to result */
+  void insert(const std::vector<ExprValue*>& key, const Expr& result);
+  /** Clear all entries */
+  void clear();
+  /** The number of entries */
+  size_t size() const { return d_entries.size(); }
+
+ private:
+  /** An entry of the cache */
+  struct Entry
+  {
+    /** The key, reference counted */
+    std::vector<Expr> d_key;
+    /** The result */
+    Expr d_result;
+  };
+  /**
+   * Estimate of the number of bytes used by an entry whose key has size n,
+   * not including the terms it keeps alive.
+   */
+  static size_t getEntrySize(size_t n);
+  /** Estimate of the number of bytes used by term e, excluding its children */
+  static size_t getTermSize(const ExprValue* e);
+  /** Add a reference to e from this cache, counting the memory of e if new */
+  void pin(const ExprValue* e);
+  /** Remove a reference to e from this cache */
+  void unpin(const ExprValue* e);
+  /** Evict the least recently used entry */
+  void evict();
+  /** The entries, from most to least recently used */
+  std::list<Entry> d_entries;
+  /** Map from keys to their entry */
+  std::unordered_map<std::vector<ExprValue*>,
+                     std::list<Entry>::iterator,
+                     ExprValueVectorHashFunction>
+      d_map;
+  /**
+   * The number of references to each term from the entries of this cache and
+   * from the other terms counted here, indexed by the identifier of the term.
+   * The memory of the terms with a non-zero count is counted.
+   */
+  std::vector<uint32_t> d_pinned;
+  /** Stack of terms to visit in pin and unpin */
+  std::vector<const ExprValue*> d_toVisit;
+  /** Reference to the statistics for hits, misses and evictions */
+  size_t& d_hits;
+  size_t& d_misses;
+  size_t& d_evictions;
+  /** The memory limit, in bytes */
+  size_t d_limit;
+  /** The estimated number of bytes used by the entries */
+  size_t d_size;
+};
+
+}  // namespace ethos
+
+#endif /* EVAL_CACHE_H */
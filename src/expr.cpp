@@ -19,19 +19,36 @@ namespace ethos {
 ExprValue ExprValue::s_null;
 State* ExprValue::d_state = nullptr;
 
-ExprValue::ExprValue() : d_kind(Kind::NONE), d_flags(0), d_rc(0) {}
+ExprValue::ExprValue()
+    : d_kind(Kind::NONE), d_flags(0), d_rc(0), d_nchildren(0), d_id(0), d_hash(0)
+{
+}
+
+ExprValue::ExprValue(Kind k)
+    : d_kind(k), d_flags(0), d_rc(0), d_nchildren(0), d_id(0), d_hash(0)
+{
+  computeFlags();
+}
 
 ExprValue::ExprValue(Kind k, const std::vector<ExprValue*>& children)
-    : d_kind(k), d_children(children), d_flags(0), d_rc(0)
+    : d_kind(k),
+      d_flags(0),
+      d_rc(0),
+      d_nchildren(static_cast<uint32_t>(children.size())),
+      d_id(0),
+      d_hash(0)
 {
-  for (ExprValue * c : children)
+  ExprValue** cs = reinterpret_cast<ExprValue**>(this + 1);
+  for (size_t i = 0, nchildren = children.size(); i < nchildren; i++)
   {
-    c->inc();
+    cs[i] = children[i];
+    cs[i]->inc();
   }
+  computeFlags();
 }
 ExprValue::~ExprValue() 
 {
-  for (ExprValue * c : d_children)
+  for (ExprValue* c : getChildren())
   {
     c->dec();
   }
@@ -41,103 +58,55 @@ bool ExprValue::isNull() const { return d_kind==Kind::NONE; }
   
 Kind ExprValue::getKind() const { return d_kind; }
 
-const std::vector<ExprValue*>& ExprValue::getChildren() const { return d_children; }
-
-size_t ExprValue::getNumChildren() const
-{
-  return d_children.size();
-}
-ExprValue* ExprValue::operator[](size_t i) const { return d_children[i]; }
 
 void ExprValue::computeFlags()
 {
-  if (getFlag(Flag::IS_FLAGS_COMPUTED))
+  ArrayView<ExprValue*> children = getChildren();
+  if (children.empty())
   {
+    setFlag(Flag::IS_NON_GROUND, d_kind == Kind::PARAM);
     return;
   }
-  std::unordered_set<ExprValue*> visited;
-  std::vector<ExprValue*> visit;
-  visit.emplace_back(this);
-  ExprValue * cur;
-  do
+  if (d_kind == Kind::APPLY)
   {
-    cur = visit.back();
-    cur->setFlag(Flag::IS_FLAGS_COMPUTED, true);
-    Kind ck = cur->getKind();
-    std::vector<ExprValue*>& children = cur->d_children;
-    if (children.empty())
+    Kind cck = children[0]->getKind();
+    if (cck == Kind::PROGRAM_CONST || cck == Kind::ORACLE)
     {
-      bool isNonGround = (ck==Kind::PARAM);
-      cur->setFlag(Flag::IS_EVAL, false);
-      cur->setFlag(Flag::IS_NON_GROUND, isNonGround);
-      visit.pop_back();
-    }
-    else if (visited.find(cur)==visited.end())
-    {
-      visited.insert(cur);
-      for (ExprValue* c : children)
-      {
-        if (!c->getFlag(Flag::IS_FLAGS_COMPUTED))
-        {
-          visit.push_back(c);
-        }
-      }
-    }
-    else
-    {
-      visit.pop_back();
-      if (ck==Kind::APPLY)
-      {
-        Kind cck = children[0]->getKind();
-        if (cck==Kind::PROGRAM_CONST || cck==Kind::ORACLE)
-        {
-          cur->setFlag(Flag::IS_PROG_EVAL, true);
-          cur->setFlag(Flag::IS_EVAL, true);
-        }
-      }
-      else if (isLiteralOp(ck))
-      {
-        // requires type and literal operator kinds evaluate
-        cur->setFlag(Flag::IS_EVAL, true);
-      }
-      for (ExprValue* c : children)
-      {
-        if (c->getFlag(Flag::IS_NON_GROUND))
-        {
-          cur->setFlag(Flag::IS_NON_GROUND, true);
-        }
-        if (c->getFlag(Flag::IS_EVAL))
-        {
-          cur->setFlag(Flag::IS_EVAL, true);
-        }
-        if (c->getFlag(Flag::IS_PROG_EVAL))
-        {
-          cur->setFlag(Flag::IS_PROG_EVAL, true);
-        }
-      }
+      setFlag(Flag::IS_PROG_EVAL, true);
+      setFlag(Flag::IS_EVAL, true);
     }
   }
-  while (!visit.empty());
+  else if (isLiteralOp(d_kind))
+  {
+    // requires type and literal operator kinds evaluate
+    setFlag(Flag::IS_EVAL, true);
+  }
+  // inherit the flags of the children
+  uint8_t inherited = static_cast<uint8_t>(Flag::IS_NON_GROUND)
+                      | static_cast<uint8_t>(Flag::IS_EVAL)
+                      | static_cast<uint8_t>(Flag::IS_PROG_EVAL);
+  for (ExprValue* c : children)
+  {
+    d_flags |= (c->d_flags & inherited);
+  }
 }
-bool ExprValue::isEvaluatable()
+
+bool ExprValue::isEvaluatable() const
 {
-  computeFlags();
   return getFlag(ExprValue::Flag::IS_EVAL);
 }
 
-bool ExprValue::isGround()
+bool ExprValue::isGround() const
 {
-  computeFlags();
   return !getFlag(ExprValue::Flag::IS_NON_GROUND);
 }
 
-bool ExprValue::isProgEvaluatable()
+bool ExprValue::isProgEvaluatable() const
 {
-  computeFlags();
   return getFlag(ExprValue::Flag::IS_PROG_EVAL);
 }
 
-bool ExprValue::isCompiled()
+bool ExprValue::isCompiled() const
 {
   // this is set manually
   return getFlag(ExprValue::Flag::IS_COMPILED);
@@ -145,6 +114,10 @@ bool ExprValue::isCompiled()
 
 void ExprValue::dec()
 {
+  if (getFlag(Flag::IS_IMMORTAL))
+  {
+    return;
+  }
   d_rc--;
   if (d_rc == 0)
   {
@@ -175,6 +148,10 @@ Expr::Expr(const Expr& e)
     d_value->inc();
   }
 }
+Expr::Expr(Expr&& e) noexcept : d_value(e.d_value)
+{
+  e.d_value = &ExprValue::s_null;
+}
 Expr::~Expr()
 {
   Assert(d_value != nullptr);
@@ -459,7 +436,7 @@ std::vector<Expr> Expr::getVariables(const std::vector<Expr>& es)
 
 size_t Expr::getNumChildren() const { return d_value->getNumChildren(); }
 
-Expr Expr::operator[](size_t i) const { return Expr(d_value->d_children[i]); }
+Expr Expr::operator[](size_t i) const { return Expr((*d_value)[i]); }
 
 Expr& Expr::operator=(const Expr& e)
 {
@@ -478,6 +455,20 @@ Expr& Expr::operator=(const Expr& e)
   return *this;
 }
 
+Expr& Expr::operator=(Expr&& e) noexcept
+{
+  if (this != &e)
+  {
+    if (!isNull())
+    {
+      d_value->dec();
+    }
+    d_value = e.d_value;
+    e.d_value = &ExprValue::s_null;
+  }
+  return *this;
+}
+
 bool Expr::operator==(const Expr& e) const { return d_value == e.d_value; }
 bool Expr::operator!=(const Expr& e) const { return d_value != e.d_value; }
 Kind Expr::getKind() const { return d_value->getKind(); }
@@ -551,7 +542,7 @@ std::ostream& operator<<(std::ostream& out, const Ctx& c)
 {
   out << "[";
   bool firstTime = true;
-  for (const std::pair<ExprValue* const, ExprValue*>& cc : c)
+  for (const std::pair<ExprValue*, ExprValue*>& cc : c)
   {
     if (firstTime)
     {
@@ -14,6 +14,7 @@
 #include <vector>
 #include <memory>
 #include "kind.h"
+#include "util/array_view.h"
 
 namespace ethos {
 
@@ -25,16 +26,24 @@ class Literal;
 
 /** 
  * Expression class
+ *
+ * The children of an expression are stored inline, immediately after the
+ * expression itself. Hence, expressions with children must be allocated with
+ * room for them, see getAllocSize.
  */
 class ExprValue
 {
   friend class TypeChecker;
   friend class Expr;
+  friend class ExprTable;
   friend class State;
+  friend class ListCache;
+  friend class EvalCache;
 
  public:
   ExprValue();
-  ExprValue(Kind k, const std::vector<ExprValue*>& children);
+  /** Construct a leaf of kind k */
+  explicit ExprValue(Kind k);
   ~ExprValue();
   /** as literal */
   virtual const Literal* asLiteral() const { return nullptr; }
@@ -43,42 +52,81 @@ class ExprValue
   /** get the kind of this expression */
   Kind getKind() const;
   /** Get children */
-  const std::vector<ExprValue*>& getChildren() const;
+  ArrayView<ExprValue*> getChildren() const
+  {
+    return ArrayView<ExprValue*>(getChildrenInternal(), d_nchildren);
+  }
   /** Get num children */
-  size_t getNumChildren() const;  
+  size_t getNumChildren() const { return d_nchildren; }
   /**
    * Returns the i-th child of this node.
    * @param i the index of the child
    * @return the node representing the i-th child
    */
-  ExprValue* operator[](size_t i) const;
+  ExprValue* operator[](size_t i) const { return getChildrenInternal()[i]; }
+  /**
+   * The number of bytes to allocate for a (non-literal) expression with the
+   * given number of children.
+   */
+  static size_t getAllocSize(size_t nchildren)
+  {
+    return sizeof(ExprValue) + nchildren * sizeof(ExprValue*);
+  }
   /** Has variable */
-  bool isEvaluatable();
+  bool isEvaluatable() const;
   /** Has variable */
-  bool isGround();
+  bool isGround() const;
   /** Has program variable */
-  bool isProgEvaluatable();
+  bool isProgEvaluatable() const;
   /** Is part of compiled code */
-  bool isCompiled();
+  bool isCompiled() const;
  protected:
+  /**
+   * Construct an expression of kind k with the given children, which must be
+   * placed in memory of size getAllocSize(children.size()).
+   */
+  ExprValue(Kind k, const std::vector<ExprValue*>& children);
+  /** Pointer to the (inline) children of this expression */
+  ExprValue* const* getChildrenInternal() const
+  {
+    return reinterpret_cast<ExprValue* const*>(this + 1);
+  }
   /** The kind */
   Kind d_kind;
-  /** The children of this expression */
-  std::vector<ExprValue*> d_children;
   /** flags */
   enum class Flag
   {
     NONE = 0,
-    IS_FLAGS_COMPUTED = (1 << 0),
-    IS_EVAL = (1 << 1),
-    IS_PROG_EVAL = (1 << 2),
-    IS_NON_GROUND = (1 << 3),
-    IS_COMPILED = (1 << 4)
+    IS_EVAL = (1 << 0),
+    IS_PROG_EVAL = (1 << 1),
+    IS_NON_GROUND = (1 << 2),
+    IS_COMPILED = (1 << 3),
+    // whether this is in the list cache of State
+    IS_LIST_CACHED = (1 << 4),
+    // whether this is never deleted, in which case it is not reference counted
+    IS_IMMORTAL = (1 << 5),
+    // whether IS_NON_LINEAR has been computed
+    IS_LINEARITY_COMPUTED = (1 << 6),
+    // whether a parameter occurs more than once in this term
+    IS_NON_LINEAR = (1 << 7)
   };
   char d_flags;
   /** */
   uint32_t d_rc;
-  /** Compute flags */
+  /** The number of children */
+  uint32_t d_nchildren;
+  /**
+   * The identifier of this expression, which indexes the side tables of State.
+   * This is 0 for expressions not constructed by State.
+   */
+  uint32_t d_id;
+  /** The hash of this expression, if it is stored in the expression table */
+  size_t d_hash;
+  /**
+   * Compute flags, called when this expression is constructed. Since the
+   * flags of the children are already computed, this is linear in the
+   * number of children.
+   */
   void computeFlags();
   /** Get flag */
   bool getFlag(Flag f) const
@@ -98,7 +146,14 @@ class ExprValue
     }
   }
   /** reference counting */
-  void inc(){ d_rc++; }
+  void inc()
+  {
+    if (getFlag(Flag::IS_IMMORTAL))
+    {
+      return;
+    }
+    d_rc++;
+  }
   void dec();
   /** Null */
   static ExprValue s_null;
@@ -112,6 +167,8 @@ class Expr
   explicit Expr();
   explicit Expr(const ExprValue* ev);
   Expr(const Expr& e);
+  /** Take the reference of e, which becomes null */
+  Expr(Expr&& e) noexcept;
   ~Expr();
   /** Get the free symbols */
   static std::vector<Expr> getVariables(const Expr& e);
@@ -134,6 +191,8 @@ class Expr
   Expr operator[](size_t i) const;
   /** Set this expression equal to e */
   Expr& operator=(const Expr& e);
+  /** Set this expression equal to e, taking its reference */
+  Expr& operator=(Expr&& e) noexcept;
   /** Returns true if this expression is equal to e*/
   bool operator==(const Expr& e) const;
   /** Returns true if this expression is not equal to e*/
@@ -184,7 +243,85 @@ class Expr
 std::ostream& operator<<(std::ostream& out, const Expr& e);
 std::ostream& operator<<(std::ostream& out, const std::vector<ExprValue*>& es);
 
-using Ctx = std::map<ExprValue*, ExprValue*>;
+/**
+ * A context, which maps parameters to terms.
+ *
+ * Contexts are small, e.g. they bind the parameters of a single program case
+ * or proof rule, hence the bindings are stored in a flat list that is
+ * searched linearly. The interface is the subset of the interface of std::map
+ * used for contexts, where bindings are added in order.
+ */
+class Ctx
+{
+ public:
+  using value_type = std::pair<ExprValue*, ExprValue*>;
+  using iterator = std::vector<value_type>::iterator;
+  using const_iterator = std::vector<value_type>::const_iterator;
+  iterator begin() { return d_binds.begin(); }
+  iterator end() { return d_binds.end(); }
+  const_iterator begin() const { return d_binds.begin(); }
+  const_iterator end() const { return d_binds.end(); }
+  bool empty() const { return d_binds.empty(); }
+  size_t size() const { return d_binds.size(); }
+  void clear() { d_binds.clear(); }
+  void swap(Ctx& c) { d_binds.swap(c.d_binds); }
+  /** Remove the bindings after the first n, i.e. the ones added last */
+  void resize(size_t n) { d_binds.resize(n); }
+  /** Find the binding for v, or end() if v is not bound */
+  iterator find(const ExprValue* v)
+  {
+    iterator it = d_binds.begin();
+    for (iterator itEnd = d_binds.end(); it != itEnd; ++it)
+    {
+      if (it->first == v)
+      {
+        break;
+      }
+    }
+    return it;
+  }
+  const_iterator find(const ExprValue* v) const
+  {
+    return const_cast<Ctx*>(this)->find(v);
+  }
+  /** Get the binding for v, which is added as nullptr if v is not bound */
+  ExprValue*& operator[](ExprValue* v)
+  {
+    iterator it = find(v);
+    if (it != d_binds.end())
+    {
+      return it->second;
+    }
+    d_binds.emplace_back(v, nullptr);
+    return d_binds.back().second;
+  }
+  /** Bind v to t, if v is not already bound */
+  std::pair<iterator, bool> emplace(ExprValue* v, ExprValue* t)
+  {
+    iterator it = find(v);
+    if (it != d_binds.end())
+    {
+      return std::pair<iterator, bool>(it, false);
+    }
+    d_binds.emplace_back(v, t);
+    return std::pair<iterator, bool>(d_binds.end() - 1, true);
+  }
+  /** Bind v to t, where v must not already be bound */
+  void bind(ExprValue* v, ExprValue* t) { d_binds.emplace_back(v, t); }
+  /** Add the bindings in [first, last) whose parameter is not already bound */
+  template <typename It>
+  void insert(It first, It last)
+  {
+    for (; first != last; ++first)
+    {
+      emplace(first->first, first->second);
+    }
+  }
+
+ private:
+  /** The bindings, in the order they were added */
+  std::vector<value_type> d_binds;
+};
 std::ostream& operator<<(std::ostream& out, const Ctx& c);
 
 }  // namespace ethos
@@ -0,0 +1,82 @@
+/******************************************************************************
+ * This file is part of the ethos project.
+ *
+ * Copyright (c) 2023-2024 by the authors listed in the file AUTHORS
+ * in the top-level source directory and their institutional affiliations.
+ * All rights reserved.  See the file COPYING in the top-level source
+ * directory for licensing information.
+ ******************************************************************************/
+#include "expr_arena.h"
+
+#include <new>
+
+#include "base/check.h"
+
+namespace ethos {
+
+/** The size of each slab */
+static const size_t s_slabSize = (1 << 20);
+/** The largest size class, in multiples of 8 bytes, served from slabs */
+static const size_t s_maxSizeClass = 64;
+
+ExprArena::ExprArena() : d_curr(nullptr), d_end(nullptr)
+{
+  d_freeLists.resize(s_maxSizeClass + 1, nullptr);
+}
+
+ExprArena::~ExprArena()
+{
+  for (char* s : d_slabs)
+  {
+    ::operator delete(s);
+  }
+}
+
+void* ExprArena::allocate(size_t size)
+{
+  size_t sc = getSizeClass(size);
+  if (sc > s_maxSizeClass)
+  {
+    return ::operator new(size);
+  }
+  void*& fl = d_freeLists[sc];
+  if (fl != nullptr)
+  {
+    // reuse a freed block of the same size
+    void* p = fl;
+    fl = *static_cast<void**>(p);
+    return p;
+  }
+  size_t bytes = sc << 3;
+  if (d_curr + bytes > d_end)
+  {
+    allocateSlab();
+  }
+  void* p = d_curr;
+  d_curr += bytes;
+  return p;
+}
+
+void ExprArena::deallocate(void* p, size_t size)
+{
+  size_t sc = getSizeClass(size);
+  if (sc > s_maxSizeClass)
+  {
+    ::operator delete(p);
+    return;
+  }
+  void*& fl = d_freeLists[sc];
+  *static_cast<void**>(p) = fl;
+  fl = p;
+}
+
+void ExprArena::allocateSlab()
+{
+  // the remainder of the current slab is abandoned
+  char* s = static_cast<char*>(::operator new(s_slabSize));
+  d_slabs.push_back(s);
+  d_curr = s;
+  d_end = s + s_slabSize;
+}
+
+}  // namespace ethos
@@ -0,0 +1,57 @@
+/******************************************************************************
+ * This file is part of the ethos project.
+ *
+ * Copyright (c) 2023-2024 by the authors listed in the file AUTHORS
+ * in the top-level source directory and their institutional affiliations.
+ * All rights reserved.  See the file COPYING in the top-level source
+ * directory for licensing information.
+ ******************************************************************************/
+#ifndef EXPR_ARENA_H
+#define EXPR_ARENA_H
+
+#include <cstddef>
+#include <vector>
+
+namespace ethos {
+
+/**
+ * A pool allocator for expressions.
+ *
+ * Memory is carved out of large slabs. Freed blocks are kept on a free list
+ * per size class (multiples of 8 bytes), and reused by later allocations of
+ * the same size. Blocks larger than the largest size class are allocated
+ * directly on the heap.
+ */
+class ExprArena
+{
+ public:
+  ExprArena();
+  ~ExprArena();
+  /** Allocate a block of the given number of bytes. */
+  void* allocate(size_t size);
+  /** Return a block of the given number of bytes, allocated by allocate. */
+  void deallocate(void* p, size_t size);
+  /** Get the number of slabs allocated so far */
+  size_t getNumSlabs() const { return d_slabs.size(); }
+
+ private:
+  /** Allocate a new slab, making it the current one */
+  void allocateSlab();
+  /** Get the size class for size */
+  static size_t getSizeClass(size_t size) { return (size + 7) >> 3; }
+  /** The slabs we have allocated */
+  std::vector<char*> d_slabs;
+  /** The next free byte in the current slab */
+  char* d_curr;
+  /** The end of the current slab */
+  char* d_end;
+  /**
+   * The free lists, indexed by size class. Each freed block stores a pointer
+   * to the next free block of its size class.
+   */
+  std::vector<void*> d_freeLists;
+};
+
+}  // namespace ethos
+
+#endif /* EXPR_ARENA_H */
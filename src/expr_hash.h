@@ -0,0 +1,51 @@
+/******************************************************************************
+ * This file is part of the ethos project.
+ *
+ * Copyright (c) 2023-2024 by the authors listed in the file AUTHORS
+ * in the top-level source directory and their institutional affiliations.
+ * All rights reserved.  See the file COPYING in the top-level source
+ * directory for licensing information.
+ ******************************************************************************/
+#ifndef EXPR_HASH_H
+#define EXPR_HASH_H
+
+#include <utility>
+#include <vector>
+
+#include "expr.h"
+
+namespace ethos {
+
+/** Combine the hash h of a sequence of terms with the next term e */
+inline size_t hashCombine(size_t h, const ExprValue* e)
+{
+  size_t v = reinterpret_cast<size_t>(e);
+  return h ^ ((v >> 4) + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2));
+}
+
+/** Hash function for pairs of terms */
+struct ExprValuePairHashFunction
+{
+  size_t operator()(const std::pair<ExprValue*, ExprValue*>& p) const
+  {
+    return hashCombine(hashCombine(2, p.first), p.second);
+  }
+};
+
+/** Hash function for sequences of terms, e.g. the keys of caches */
+struct ExprValueVectorHashFunction
+{
+  size_t operator()(const std::vector<ExprValue*>& key) const
+  {
+    size_t h = key.size();
+    for (const ExprValue* e : key)
+    {
+      h = hashCombine(h, e);
+    }
+    return h;
+  }
+};
+
+}  // namespace ethos
+
+#endif /* EXPR_HASH_H */
@@ -12,9 +12,12 @@
 #include <map>
 #include <string>
 #include <memory>
+#include <vector>
 
 #include "kind.h"
 #include "attr.h"
+#include "case_index.h"
+#include "compiled_pattern.h"
 #include "expr.h"
 
 namespace ethos {
@@ -27,7 +30,13 @@ using AttrMap = std::map<Attr, std::vector<Expr>>;
 class AppInfo
 {
 public:
-  AppInfo() : d_attrCons( ), d_kind(Kind::NONE) {}
+  AppInfo()
+      : d_attrCons(),
+        d_kind(Kind::NONE),
+        d_numQuotedOverloads(0),
+        d_hasCompiledArgTypes(false)
+  {
+  }
   /** Attribute */
   Attr d_attrCons;
   /** Attribute */
@@ -36,6 +45,23 @@ public:
   Kind d_kind;
   /** Overloading */
   std::vector<Expr> d_overloads;
+  /** The number of overloads in d_overloads that have a quoted argument */
+  size_t d_numQuotedOverloads;
+  /** The index over the cases, if this is a defined program */
+  std::unique_ptr<CaseIndex> d_caseIndex;
+  /**
+   * For programs, the compiled pattern for the arguments of each case, which
+   * are computed on demand when --bytecode-match is enabled.
+   */
+  std::vector<std::unique_ptr<CompiledPattern>> d_compiledCases;
+  /**
+   * For function types, the compiled pattern for the argument types, which
+   * is computed on demand when --bytecode-match is enabled. This is null if they
+   * cannot be compiled.
+   */
+  std::unique_ptr<CompiledPattern> d_compiledArgTypes;
+  /** Whether d_compiledArgTypes has been computed */
+  bool d_hasCompiledArgTypes;
 };
 
 }  // namespace ethos
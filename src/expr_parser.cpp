@@ -287,12 +287,12 @@ Expr ExprParser::parseExpr()
         // normalize to rational if not signature and option is set
         if (!d_isSignature && d_state.getOptions().d_normalizeNumeral)
         {
-          Rational r(d_lex.tokenStr());
+          Rational r(std::string(d_lex.tokenStr()));
           ret = d_state.mkLiteral(Kind::RATIONAL, r.toString());
         }
         else
         {
-          ret = d_state.mkLiteral(Kind::NUMERAL, d_lex.tokenStr());
+          ret = d_state.mkLiteral(Kind::NUMERAL, std::string(d_lex.tokenStr()));
         }
       }
       break;
@@ -302,18 +302,18 @@ Expr ExprParser::parseExpr()
         if (!d_isSignature && d_state.getOptions().d_normalizeDecimal)
         {
           // normalize from decimal
-          Rational r = Rational::fromDecimal(d_lex.tokenStr());
+          Rational r = Rational::fromDecimal(std::string(d_lex.tokenStr()));
           ret = d_state.mkLiteral(Kind::RATIONAL, r.toString());
         }
         else
         {
-          ret = d_state.mkLiteral(Kind::DECIMAL, d_lex.tokenStr());
+          ret = d_state.mkLiteral(Kind::DECIMAL, std::string(d_lex.tokenStr()));
         }
       }
       break;
       case Token::RATIONAL_LITERAL:
       {
-        std::string s = d_lex.tokenStr();
+        std::string s(d_lex.tokenStr());
         size_t spos = s.find('/');
         if (spos != std::string::npos)
         {
@@ -330,7 +330,7 @@ Expr ExprParser::parseExpr()
       break;
       case Token::HEX_LITERAL:
       {
-        std::string hexStr = d_lex.tokenStr();
+        std::string hexStr(d_lex.tokenStr());
         hexStr = hexStr.substr(2);
         // normalize to binary if not signature and option is set
         if (!d_isSignature && d_state.getOptions().d_normalizeHexadecimal)
@@ -347,14 +347,14 @@ Expr ExprParser::parseExpr()
       break;
       case Token::BINARY_LITERAL:
       {
-        std::string binStr = d_lex.tokenStr();
+        std::string binStr(d_lex.tokenStr());
         binStr = binStr.substr(2);
         ret = d_state.mkLiteral(Kind::BINARY, binStr);
       }
       break;
       case Token::STRING_LITERAL:
       {
-        std::string s = d_lex.tokenStr();
+        std::string s(d_lex.tokenStr());
         unescapeString(s);
         // now, must run through String utility so that its unicode
         // handling is unique
@@ -1026,7 +1026,7 @@ void ExprParser::parseConstructorDefinitionList(
 std::string ExprParser::parseKeyword()
 {
   d_lex.eatToken(Token::KEYWORD);
-  std::string s = d_lex.tokenStr();
+  std::string s(d_lex.tokenStr());
   // strip off the initial colon
   return s.erase(0, 1);
 }
@@ -1040,7 +1040,7 @@ uint32_t ExprParser::parseIntegerNumeral()
 uint32_t ExprParser::tokenStrToUnsigned()
 {
   // forbid leading zeroes?
-  std::string token = d_lex.tokenStr();
+  std::string token(d_lex.tokenStr());
   if (token.size() > 1 && token[0] == '0')
   {
     d_lex.parseError("Numeral with leading zeroes are forbidden");
@@ -1077,7 +1077,7 @@ std::string ExprParser::tokenStrToSymbol(Token tok)
 std::string ExprParser::parseStr(bool unescape)
 {
   d_lex.eatToken(Token::STRING_LITERAL);
-  std::string s = d_lex.tokenStr();
+  std::string s(d_lex.tokenStr());
   if (unescape)
   {
     unescapeString(s);
@@ -1091,7 +1091,7 @@ void ExprParser::parseAttributeList(Kind k, Expr& e, AttrMap& attrs, bool& pushe
   // while the next token is KEYWORD, exit if RPAREN
   while (d_lex.eatTokenChoice(Token::KEYWORD, Token::RPAREN))
   {
-    std::string key = d_lex.tokenStr();
+    std::string key(d_lex.tokenStr());
     its = d_strToAttr.find(key);
     Expr val;
     if (its==d_strToAttr.end())
@@ -1335,7 +1335,7 @@ void ExprParser::bind(const std::string& name, Expr& e)
   }
 }
 
-Expr ExprParser::typeCheck(Expr& e)
+Expr ExprParser::typeCheck(const Expr& e)
 {
   // type check immediately
   const Expr& v = d_state.getTypeChecker().getType(e);
@@ -1353,10 +1353,10 @@ Expr ExprParser::typeCheck(Expr& e)
   }
   return v;
 }
-Expr ExprParser::typeCheckApp(std::vector<Expr>& children)
+Expr ExprParser::typeCheckApp(ArrayView<Expr> children)
 {
   // ensure all children are type checked
-  for (Expr& c : children)
+  for (const Expr& c : children)
   {
     typeCheck(c);
   }
@@ -128,9 +128,9 @@ class ExprParser
   Kind parseLiteralKind();
   //-------------------------- checking
   /** type check the expression */
-  Expr typeCheck(Expr& e);
+  Expr typeCheck(const Expr& e);
   /** type check (APPLY children), without constructing the APPLY */
-  Expr typeCheckApp(std::vector<Expr>& children);
+  Expr typeCheckApp(ArrayView<Expr> children);
   /** ensure type */
   Expr typeCheck(Expr& e, const Expr& expected);
   /** get variable, else error */
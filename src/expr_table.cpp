@@ -0,0 +1,139 @@
+/******************************************************************************
+ * This file is part of the ethos project.
+ *
+ * Copyright (c) 2023-2024 by the authors listed in the file AUTHORS
+ * in the top-level source directory and their institutional affiliations.
+ * All rights reserved.  See the file COPYING in the top-level source
+ * directory for licensing information.
+ ******************************************************************************/
+#include "expr_table.h"
+
+#include <algorithm>
+
+#include "base/check.h"
+#include "expr_hash.h"
+
+namespace ethos {
+
+ExprValue ExprTable::s_tombstone;
+
+ExprTable::ExprTable() : d_size(0), d_used(0)
+{
+  d_slots.resize(1024, nullptr);
+}
+
+ExprTable::~ExprTable() {}
+
+size_t ExprTable::computeHash(Kind k, const std::vector<ExprValue*>& children)
+{
+  size_t h = static_cast<size_t>(k);
+  for (const ExprValue* c : children)
+  {
+    h = hashCombine(h, c);
+  }
+  // finalize so that the low bits, which select the slot, are well mixed
+  h ^= h >> 33;
+  h *= 0xff51afd7ed558ccdULL;
+  h ^= h >> 33;
+  return h;
+}
+
+ExprValue* ExprTable::find(Kind k,
+                           const std::vector<ExprValue*>& children,
+                           size_t h,
+                           size_t& slot,
+                           size_t& probes) const
+{
+  size_t mask = d_slots.size() - 1;
+  size_t i = h & mask;
+  bool foundFree = false;
+  for (;;)
+  {
+    probes++;
+    ExprValue* e = d_slots[i];
+    if (e == nullptr)
+    {
+      // insert into the first tombstone we saw, if any
+      if (!foundFree)
+      {
+        slot = i;
+      }
+      return nullptr;
+    }
+    if (e == &s_tombstone)
+    {
+      if (!foundFree)
+      {
+        foundFree = true;
+        slot = i;
+      }
+    }
+    else if (e->d_hash == h && e->d_kind == k
+             && e->d_nchildren == children.size()
+             && std::equal(children.begin(),
+                           children.end(),
+                           e->getChildrenInternal()))
+    {
+      return e;
+    }
+    i = (i + 1) & mask;
+  }
+}
+
+void ExprTable::insert(size_t slot, ExprValue* e)
+{
+  Assert(slot < d_slots.size());
+  Assert(d_slots[slot] == nullptr || d_slots[slot] == &s_tombstone);
+  if (d_slots[slot] == nullptr)
+  {
+    d_used++;
+  }
+  d_slots[slot] = e;
+  d_size++;
+  // keep the load factor (including tombstones) below 3/4
+  size_t capacity = d_slots.size();
+  if (4 * d_used > 3 * capacity)
+  {
+    // grow if mostly live expressions, otherwise just clear tombstones
+    rehash(2 * d_size > capacity ? 2 * capacity : capacity);
+  }
+}
+
+void ExprTable::remove(ExprValue* e)
+{
+  size_t mask = d_slots.size() - 1;
+  size_t i = e->d_hash & mask;
+  while (d_slots[i] != e)
+  {
+    Assert(d_slots[i] != nullptr) << "Removing an expression not in the table";
+    i = (i + 1) & mask;
+  }
+  d_slots[i] = &s_tombstone;
+  d_size--;
+}
+
+size_t ExprTable::size() const { return d_size; }
+
+void ExprTable::rehash(size_t capacity)
+{
+  std::vector<ExprValue*> old;
+  old.swap(d_slots);
+  d_slots.resize(capacity, nullptr);
+  size_t mask = capacity - 1;
+  for (ExprValue* e : old)
+  {
+    if (e == nullptr || e == &s_tombstone)
+    {
+      continue;
+    }
+    size_t i = e->d_hash & mask;
+    while (d_slots[i] != nullptr)
+    {
+      i = (i + 1) & mask;
+    }
+    d_slots[i] = e;
+  }
+  d_used = d_size;
+}
+
+}  // namespace ethos
@@ -0,0 +1,76 @@
+/******************************************************************************
+ * This file is part of the ethos project.
+ *
+ * Copyright (c) 2023-2024 by the authors listed in the file AUTHORS
+ * in the top-level source directory and their institutional affiliations.
+ * All rights reserved.  See the file COPYING in the top-level source
+ * directory for licensing information.
+ ******************************************************************************/
+#ifndef EXPR_TABLE_H
+#define EXPR_TABLE_H
+
+#include <vector>
+
+#include "expr.h"
+
+namespace ethos {
+
+/**
+ * The unique table of hash-consed expressions.
+ *
+ * This is an open-addressing hash table with linear probing, keyed on the
+ * kind and children of an expression. The hash of each expression is stored
+ * on the expression itself (ExprValue::d_hash), so that rehashing and removal
+ * never recompute it. Removal is done by leaving a tombstone in the slot of
+ * the removed expression.
+ */
+class ExprTable
+{
+ public:
+  ExprTable();
+  ~ExprTable();
+  /** Compute the hash of the expression with kind k and the given children. */
+  static size_t computeHash(Kind k, const std::vector<ExprValue*>& children);
+  /**
+   * Find the expression with kind k and the given children, whose hash is h.
+   * Returns nullptr if it does not exist, in which case slot is set to the
+   * slot that the expression should be inserted into via insert.
+   *
+   * @param k The kind of the expression.
+   * @param children The children of the expression.
+   * @param h The hash of (k, children), computed by computeHash.
+   * @param slot Updated to the insertion slot if we return nullptr.
+   * @param probes Incremented by the number of slots inspected.
+   * @return The expression, if it exists.
+   */
+  ExprValue* find(Kind k,
+                  const std::vector<ExprValue*>& children,
+                  size_t h,
+                  size_t& slot,
+                  size_t& probes) const;
+  /**
+   * Insert e into the given slot, which was computed by the last call to find.
+   * The hash of e must already be set.
+   */
+  void insert(size_t slot, ExprValue* e);
+  /** Remove e from this table, which leaves a tombstone in its slot. */
+  void remove(ExprValue* e);
+  /** The number of expressions stored in this table. */
+  size_t size() const;
+
+ private:
+  /** Resize to the given capacity, which drops all tombstones. */
+  void rehash(size_t capacity);
+  /** The marker for removed slots */
+  static ExprValue s_tombstone;
+  /** The slots, whose size is always a power of two */
+  std::vector<ExprValue*> d_slots;
+  /** The number of expressions in d_slots */
+  size_t d_size;
+  /** The number of non-empty slots, including tombstones */
+  size_t d_used;
+};
+
+}  // namespace ethos
+
+#endif /* EXPR_TABLE_H */
@@ -35,36 +35,6 @@ public:
     }
     return et;
   }
-  /** */
-  void remove(const std::vector<ExprValue*>& children)
-  {
-    ExprTrie* et = this;
-    ExprTrie* etd = nullptr;
-    std::map<const ExprValue*, ExprTrie>::iterator itet;
-    std::map<const ExprValue*, ExprTrie>::iterator itetd;
-    for (ExprValue* e : children)
-    {
-      itet = et->d_children.find(e);
-      if (etd == nullptr)
-      {
-        // etd is the candidate trie to delete from
-        etd = et;
-        itetd = itet;
-      }
-      Assert (itet!=et->d_children.end());
-      if (et->d_children.size() > 1)
-      {
-        etd = nullptr;
-      }
-      et = &itet->second;
-    }
-    // delete the subtree for which et->d_data occurs in a single path
-    if (etd!=nullptr)
-    {
-      etd->d_children.erase(itetd);
-    }
-    et->d_data = nullptr;
-  }
 };
 
 }  // namespace ethos
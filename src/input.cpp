@@ -8,6 +8,13 @@
  ******************************************************************************/
 #include "input.h"
 
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
 #include <fstream>
 #include <iostream>
 
@@ -15,34 +22,87 @@
 
 namespace ethos {
 
-/** File input class */
+/**
+ * File input class. Regular files are memory-mapped, other files, e.g. named
+ * pipes, are read via a stream.
+ */
 class FileInput : public Input
 {
  public:
-  FileInput(const std::string& filename) : Input()
+  FileInput(const std::string& filename)
+      : Input(), d_data(nullptr), d_size(0)
   {
+#ifndef _WIN32
+    int fd = open(filename.c_str(), O_RDONLY);
+    if (fd != -1)
+    {
+      struct stat st;
+      // empty files cannot be mapped
+      if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0)
+      {
+        size_t size = static_cast<size_t>(st.st_size);
+        void* data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data != MAP_FAILED)
+        {
+          // we read the file once from start to end
+          madvise(data, size, MADV_SEQUENTIAL);
+          d_data = static_cast<const char*>(data);
+          d_size = size;
+        }
+      }
+      close(fd);
+      if (d_data != nullptr)
+      {
+        return;
+      }
+    }
+#endif
     d_fs.open(filename, std::fstream::in);
     if (!d_fs.is_open())
     {
       EO_FATAL() << "Couldn't open file: " << filename;
     }
   }
+  ~FileInput()
+  {
+#ifndef _WIN32
+    if (d_data != nullptr)
+    {
+      munmap(const_cast<char*>(d_data), d_size);
+    }
+#endif
+  }
   std::istream* getStream() override { return &d_fs; }
+  const char* getBuffer(size_t& size) override
+  {
+    size = d_size;
+    return d_data;
+  }
+
  private:
-  /** File stream */
+  /** File stream, if the file is not mapped */
   std::ifstream d_fs;
+  /** The mapped contents of the file, if it is mapped */
+  const char* d_data;
+  /** The size of d_data */
+  size_t d_size;
 };
 /** Stream reference input class */
 class StreamInput : public Input
 {
  public:
-  StreamInput(std::istream& input) : Input(), d_input(input) {}
+  StreamInput(std::istream& input, bool interactive)
+      : Input(), d_input(input), d_interactive(interactive)
+  {
+  }
   std::istream* getStream() override { return &d_input; }
-  bool isInteractive() const override { return true; }
+  bool isInteractive() const override { return d_interactive; }
 
  private:
   /** Reference to stream */
   std::istream& d_input;
+  /** Whether the stream is interactive */
+  bool d_interactive;
 };
 /** String input class */
 class StringInput : public Input
@@ -62,13 +122,20 @@ Input::Input() {}
 
 bool Input::isInteractive() const { return false; }
 
+const char* Input::getBuffer(size_t& size)
+{
+  size = 0;
+  return nullptr;
+}
+
 std::unique_ptr<Input> Input::mkFileInput(const std::string& filename)
 {
   return std::unique_ptr<Input>(new FileInput(filename));
 }
-std::unique_ptr<Input> Input::mkStreamInput(std::istream& input)
+std::unique_ptr<Input> Input::mkStreamInput(std::istream& input,
+                                            bool interactive)
 {
-  return std::unique_ptr<Input>(new StreamInput(input));
+  return std::unique_ptr<Input>(new StreamInput(input, interactive));
 }
 std::unique_ptr<Input> Input::mkStringInput(const std::string& input)
 {
@@ -18,7 +18,8 @@ namespace ethos {
 /**
  * Wrapper to setup the necessary information for constructing a Lexer.
  *
- * Currently this is std::istream& obtainable via getStream.
+ * This is either the contents of the input in memory, obtainable via
+ * getBuffer, or otherwise a std::istream& obtainable via getStream.
  */
 class Input
 {
@@ -33,8 +34,11 @@ class Input
   /** Set the input for the given stream.
    *
    * @param input the input
+   * @param interactive whether the stream is interactive, e.g. a terminal.
+   * If not, e.g. if it is a pipe, it is read in blocks.
    */
-  static std::unique_ptr<Input> mkStreamInput(std::istream& input);
+  static std::unique_ptr<Input> mkStreamInput(std::istream& input,
+                                              bool interactive = true);
   /** Set the input for the given string.
    *
    * @param input the input
@@ -42,6 +46,15 @@ class Input
   static std::unique_ptr<Input> mkStringInput(const std::string& input);
   /** Get the stream to pass to the lexer. */
   virtual std::istream* getStream() = 0;
+  /**
+   * Get the entire contents of this input, if they are available in memory,
+   * e.g. if this is a file that has been memory-mapped. The lexer then reads
+   * from this buffer instead of the stream.
+   *
+   * @param size Set to the size of the buffer.
+   * @return The buffer, or nullptr if this input must be read from its stream.
+   */
+  virtual const char* getBuffer(size_t& size);
   /**
    * Is the stream of this input an interactive input? If so, we will read
    * it character-by-character.
@@ -277,5 +277,39 @@ bool isListLiteralOp(Kind k)
   }
   return false;
 }
+bool isValueLiteralOp(Kind k)
+{
+  switch (k)
+  {
+    // boolean
+    case Kind::EVAL_NOT:
+    case Kind::EVAL_AND:
+    case Kind::EVAL_OR:
+    case Kind::EVAL_XOR:
+    // arithmetic
+    case Kind::EVAL_ADD:
+    case Kind::EVAL_NEG:
+    case Kind::EVAL_MUL:
+    case Kind::EVAL_INT_DIV:
+    case Kind::EVAL_INT_MOD:
+    case Kind::EVAL_RAT_DIV:
+    case Kind::EVAL_IS_NEG:
+    case Kind::EVAL_GT:
+    // strings
+    case Kind::EVAL_LENGTH:
+    case Kind::EVAL_CONCAT:
+    case Kind::EVAL_EXTRACT:
+    case Kind::EVAL_FIND:
+    // conversions
+    case Kind::EVAL_TO_INT:
+    case Kind::EVAL_TO_RAT:
+    case Kind::EVAL_TO_BIN:
+    case Kind::EVAL_TO_STRING:
+      return true;
+    default:
+      break;
+  }
+  return false;
+}
 
 }  // namespace ethos
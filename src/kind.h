@@ -117,6 +117,11 @@ bool isLiteral(Kind k);
 bool isLiteralOp(Kind k);
 /** Is k a list literal operator? */
 bool isListLiteralOp(Kind k);
+/**
+ * Is k a literal operator whose result depends only on the values of its
+ * arguments, e.g. an arithmetic operator?
+ */
+bool isValueLiteralOp(Kind k);
 
 }  // namespace ethos
 
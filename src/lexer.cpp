@@ -26,8 +26,16 @@ std::ostream& operator<<(std::ostream& o, const Span& l)
 }
 
 Lexer::Lexer(bool lexLet)
-    : d_lexLet(lexLet), d_isInteractive(false), d_bufferPos(0), d_bufferEnd(0),
-      d_peekedChar(false), d_chPeeked(0)
+    : d_lexLet(lexLet),
+      d_isInteractive(false),
+      d_isMapped(false),
+      d_data(d_buffer),
+      d_bufferPos(0),
+      d_bufferEnd(0),
+      d_peekedChar(false),
+      d_chPeeked(0),
+      d_tokenStart(0),
+      d_tokenSize(0)
 {
   for (int32_t ch = 'a'; ch <= 'z'; ++ch)
   {
@@ -108,6 +116,21 @@ void Lexer::initialize(Input* input, const std::string& inputName)
   d_bufferEnd = 0;
   d_peekedChar = false;
   d_chPeeked = 0;
+  d_tokenStart = 0;
+  d_tokenSize = 0;
+  // if the input is in memory, read from it directly
+  size_t size;
+  const char* data = input->getBuffer(size);
+  d_isMapped = data != nullptr;
+  if (d_isMapped)
+  {
+    d_data = data;
+    d_bufferEnd = size;
+  }
+  else
+  {
+    d_data = d_buffer;
+  }
 }
 
 Token Lexer::nextToken()
@@ -174,19 +197,21 @@ bool Lexer::eatTokenChoice(Token t, Token f)
 }
 
 
-const char* Lexer::tokenStr() const
+std::string_view Lexer::tokenStr() const
 {
-  Assert(!d_token.empty() && d_token.back() == 0);
-  return d_token.data();
+  if (d_isMapped)
+  {
+    return std::string_view(d_data + d_tokenStart, d_tokenSize);
+  }
+  return std::string_view(d_token.data(), d_token.size());
 }
 
 Token Lexer::nextTokenInternal()
 {
   //Trace("lexer-debug") << "Call nextToken" << std::endl;
   d_token.clear();
+  d_tokenSize = 0;
   Token ret = computeNextToken();
-  // null terminate?
-  d_token.push_back(0);
   //Trace("lexer-debug") << "Return nextToken " << ret << " / " << tokenStr() << std::endl;
   return ret;
 }
@@ -382,29 +407,30 @@ void Lexer::parseCharList(CharacterClass cc)
 
 Token Lexer::tokenizeCurrentSymbol() const
 {
-  Assert(!d_token.empty());
-  switch (d_token[0])
+  std::string_view token = tokenStr();
+  Assert(!token.empty());
+  switch (token[0])
   {
     case '-':
     {
-      if (d_token.size()>=2)
+      if (token.size()>=2)
       {
         // reparse as a negative numeral, rational or decimal
         Token ret = Token::INTEGER_LITERAL;
-        for (size_t i=1, tsize = d_token.size(); i<tsize; i++)
+        for (size_t i=1, tsize = token.size(); i<tsize; i++)
         {
-          if (isCharacterClass(d_token[i], CharacterClass::DECIMAL_DIGIT))
+          if (isCharacterClass(token[i], CharacterClass::DECIMAL_DIGIT))
           {
             continue;
           }
           else if (i+1<tsize && ret==Token::INTEGER_LITERAL)
           {
-            if (d_token[i]=='.')
+            if (token[i]=='.')
             {
               ret = Token::DECIMAL_LITERAL;
               continue;
             }
-            else if (d_token[i]=='/')
+            else if (token[i]=='/')
             {
               ret = Token::RATIONAL_LITERAL;
               continue;
@@ -417,17 +443,17 @@ Token Lexer::tokenizeCurrentSymbol() const
     }
       break;
     case 'e':
-      if (d_token.size()>=4 && d_token[1] == 'o' && d_token[2] == ':' && d_token[3] == ':')
+      if (token.size()>=4 && token[1] == 'o' && token[2] == ':' && token[3] == ':')
       {
-        if (d_token.size()==9 && d_token[4]=='m' && d_token[5]=='a' &&
-            d_token[6]=='t' && d_token[7]=='c' && d_token[8]=='h')
+        if (token.size()==9 && token[4]=='m' && token[5]=='a' &&
+            token[6]=='t' && token[7]=='c' && token[8]=='h')
         {
           // eo::match
           return Token::EVAL_MATCH;
         }
-        else if (d_token.size()==10 && d_token[4]=='d' && d_token[5]=='e' &&
-                 d_token[6]=='f' && d_token[7]=='i' && d_token[8]=='n' &&
-                 d_token[9]=='e')
+        else if (token.size()==10 && token[4]=='d' && token[5]=='e' &&
+                 token[6]=='f' && token[7]=='i' && token[8]=='n' &&
+                 token[9]=='e')
         {
           // eo::define
           return Token::EVAL_DEFINE;
@@ -435,26 +461,26 @@ Token Lexer::tokenizeCurrentSymbol() const
       }
       break;
     case 'p':
-      if (d_token.size() == 3 && d_token[1] == 'a' && d_token[2] == 'r')
+      if (token.size() == 3 && token[1] == 'a' && token[2] == 'r')
       {
         return Token::PAR;
       }
       break;
     case 'l':
       // only lex let if option is true (d_lexLet)
-      if (d_lexLet && d_token.size() == 3 && d_token[1] == 'e' && d_token[2] == 't')
+      if (d_lexLet && token.size() == 3 && token[1] == 'e' && token[2] == 't')
       {
         return Token::LET;
       }
       break;
     case 'B':
-      if (d_token.size() == 4 && d_token[1] == 'o' && d_token[2] == 'o' && d_token[3] == 'l')
+      if (token.size() == 4 && token[1] == 'o' && token[2] == 'o' && token[3] == 'l')
       {
         return Token::BOOL_TYPE;
       }
       break;
     case 'T':
-      if (d_token.size() == 4 && d_token[1] == 'y' && d_token[2] == 'p' && d_token[3] == 'e')
+      if (token.size() == 4 && token[1] == 'y' && token[2] == 'p' && token[3] == 'e')
       {
         return Token::TYPE;
       }
@@ -13,6 +13,7 @@
 #include <fstream>
 #include <iosfwd>
 #include <string>
+#include <string_view>
 #include <vector>
 
 #include "base/check.h"
@@ -55,9 +56,9 @@ class Lexer
   void initialize(Input* input, const std::string& inputName);
   /**
    * String corresponding to the last token (old top of stack). This is only
-   * valid if no tokens are currently peeked.
+   * valid if no tokens are currently peeked, and until the next token is read.
    */
-  const char* tokenStr() const;
+  std::string_view tokenStr() const;
   /** Advance to the next token (pop from stack) */
   Token nextToken();
   /** Add a token back into the stream (push to stack) */
@@ -87,9 +88,13 @@ class Lexer
   {
     if (d_bufferPos < d_bufferEnd)
     {
-      d_ch = d_buffer[d_bufferPos];
+      d_ch = static_cast<unsigned char>(d_data[d_bufferPos]);
       d_bufferPos++;
     }
+    else if (d_isMapped)
+    {
+      d_ch = EOF;
+    }
     else if (d_isInteractive)
     {
       d_ch = d_istream->get();
@@ -105,7 +110,7 @@ class Lexer
       }
       else
       {
-        d_ch = d_buffer[0];
+        d_ch = static_cast<unsigned char>(d_buffer[0]);
         d_bufferPos = 1;
       }
     }
@@ -176,7 +181,14 @@ class Lexer
   bool d_lexLet;
   /** True if the input stream is interactive */
   bool d_isInteractive;
-  /** The current buffer */
+  /**
+   * True if the input is in memory, in which case d_data is the entire input
+   * and tokens are not copied into d_token.
+   */
+  bool d_isMapped;
+  /** The buffer we are reading from, either the input or d_buffer */
+  const char* d_data;
+  /** The current buffer, if the input is read from a stream */
   char d_buffer[INPUT_BUFFER_SIZE];
   /** The position in the current buffer we are reading from */
   size_t d_bufferPos;
@@ -193,10 +205,22 @@ class Lexer
    * null terminate.
    */
   Token computeNextToken();
-  /** Push a character to the stored token */
+  /**
+   * Push a character to the stored token. Note that ch is always the last
+   * character read.
+   */
   void pushToToken(int32_t ch)
   {
     Assert(ch != EOF);
+    if (d_isMapped)
+    {
+      if (d_tokenSize == 0)
+      {
+        d_tokenStart = d_bufferPos - 1;
+      }
+      d_tokenSize++;
+      return;
+    }
     d_token.push_back(static_cast<char>(ch));
   }
   //----------- Utilities for parsing the current character stream
@@ -238,8 +262,12 @@ class Lexer
    * We don't handle command tokens here.
    */
   Token tokenizeCurrentSymbol() const;
-  /** The characters in the current token */
+  /** The characters in the current token, if the input is not in memory */
   std::vector<char> d_token;
+  /** The position of the current token in d_data, if the input is in memory */
+  size_t d_tokenStart;
+  /** The size of the current token, if the input is in memory */
+  size_t d_tokenSize;
   /** The character classes. */
   std::array<uint8_t, 256> d_charClass{};  // value-initialized to 0
 };
@@ -0,0 +1,90 @@
+/******************************************************************************
+ * This file is part of the ethos project.
+ *
+ * Copyright (c) 2023-2024 by the authors listed in the file AUTHORS
+ * in the top-level source directory and their institutional affiliations.
+ * All rights reserved.  See the file COPYING in the top-level source
+ * directory for licensing information.
+ ******************************************************************************/
+#include "list_cache.h"
+
+#include "base/check.h"
+
+namespace ethos {
+
+ListCache::ListCache() {}
+
+ListCache::~ListCache() {}
+
+ListView ListCache::get(ExprValue* e, ExprValue* op, bool isLeft)
+{
+  // collect the applications of op until a cached one or the end
+  std::vector<ExprValue*> apps;
+  Entry* tail = nullptr;
+  ExprValue* curr = e;
+  while (curr->getKind() == Kind::APPLY)
+  {
+    ExprValue* cop = (*curr)[0];
+    if (cop->getKind() != Kind::APPLY || (*cop)[0] != op)
+    {
+      break;
+    }
+    if (curr->getFlag(ExprValue::Flag::IS_LIST_CACHED))
+    {
+      std::unordered_map<const ExprValue*, Entry>::iterator it =
+          d_entries.find(curr);
+      Assert(it != d_entries.end());
+      tail = &it->second;
+      break;
+    }
+    apps.push_back(curr);
+    curr = isLeft ? (*cop)[1] : (*curr)[1];
+  }
+  std::shared_ptr<Data> data;
+  size_t size = 0;
+  if (tail != nullptr)
+  {
+    data = tail->d_data;
+    size = tail->d_size;
+    if (apps.empty())
+    {
+      return ListView(data->d_rev.data(), size, data->d_end);
+    }
+    // if another list was built on this tail already, copy its elements
+    if (data->d_rev.size() != size)
+    {
+      std::shared_ptr<Data> cdata = std::make_shared<Data>(data->d_end);
+      cdata->d_rev.assign(data->d_rev.begin(), data->d_rev.begin() + size);
+      data = cdata;
+    }
+  }
+  else if (apps.empty())
+  {
+    // not a list
+    return ListView(nullptr, 0, e);
+  }
+  else
+  {
+    data = std::make_shared<Data>(curr);
+  }
+  // add the applications from the innermost one
+  for (size_t i = apps.size(); i > 0; i--)
+  {
+    ExprValue* app = apps[i - 1];
+    data->d_rev.push_back(isLeft ? (*app)[1] : (*(*app)[0])[1]);
+    size++;
+    Entry& en = d_entries[app];
+    en.d_data = data;
+    en.d_size = size;
+    app->setFlag(ExprValue::Flag::IS_LIST_CACHED, true);
+  }
+  return ListView(data->d_rev.data(), size, data->d_end);
+}
+
+void ListCache::erase(ExprValue* e)
+{
+  Assert(e->getFlag(ExprValue::Flag::IS_LIST_CACHED));
+  d_entries.erase(e);
+}
+
+}  // namespace ethos
@@ -0,0 +1,103 @@
+/******************************************************************************
+ * This file is part of the ethos project.
+ *
+ * Copyright (c) 2023-2024 by the authors listed in the file AUTHORS
+ * in the top-level source directory and their institutional affiliations.
+ * All rights reserved.  See the file COPYING in the top-level source
+ * directory for licensing information.
+ ******************************************************************************/
+#ifndef LIST_CACHE_H
+#define LIST_CACHE_H
+
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "expr.h"
+
+namespace ethos {
+
+/**
+ * A flattened view of a list, i.e. a chain of applications of an associative
+ * operator. This is only valid until the next call to ListCache::get.
+ */
+class ListView
+{
+ public:
+  ListView(ExprValue* const* rev, size_t size, ExprValue* end)
+      : d_rev(rev), d_size(size), d_end(end)
+  {
+  }
+  /** The number of elements */
+  size_t size() const { return d_size; }
+  /** The i^th element */
+  ExprValue* operator[](size_t i) const { return d_rev[d_size - 1 - i]; }
+  /** The term at the end of the chain, e.g. its nil terminator */
+  ExprValue* getEnd() const { return d_end; }
+
+ private:
+  /** The elements, in reverse order */
+  ExprValue* const* d_rev;
+  /** The number of elements */
+  size_t d_size;
+  /** The end of the chain */
+  ExprValue* d_end;
+};
+
+/**
+ * Caches the flattened form of lists, so that they are traversed once.
+ *
+ * Lists are stored as nested binary applications, where the tail of a list is
+ * itself a list. The elements of a chain are stored once, in reverse order,
+ * in a vector that is shared by all of its tails. Each application in the
+ * chain maps to this vector and the number of elements from it onwards.
+ * Adding an element to a cached list appends to the vector of its tail if no
+ * other list has done so already, so building a list one element at a time
+ * takes linear time overall.
+ *
+ * The entry for an application is removed when it is deleted.
+ */
+class ListCache
+{
+ public:
+  ListCache();
+  ~ListCache();
+  /**
+   * Get the flattened view of the list e whose operator is op.
+   *
+   * @param e The list.
+   * @param op The associative operator.
+   * @param isLeft Whether op is left associative, i.e. whether the tail of an
+   * application of op is its first argument.
+   * @return The view of e. If e is not an application of op, this is empty
+   * and its end is e.
+   */
+  ListView get(ExprValue* e, ExprValue* op, bool isLeft);
+  /** Remove the entry for e, which is being deleted */
+  void erase(ExprValue* e);
+
+ private:
+  /** The shared elements of a chain */
+  struct Data
+  {
+    Data(ExprValue* end) : d_end(end) {}
+    /** The elements in reverse order */
+    std::vector<ExprValue*> d_rev;
+    /** The end of the chain */
+    ExprValue* d_end;
+  };
+  /** An entry, for an application in a chain */
+  struct Entry
+  {
+    /** The elements of the chain */
+    std::shared_ptr<Data> d_data;
+    /** The number of elements of the list starting from the application */
+    size_t d_size;
+  };
+  /** The entries */
+  std::unordered_map<const ExprValue*, Entry> d_entries;
+};
+
+}  // namespace ethos
+
+#endif /* LIST_CACHE_H */
@@ -41,8 +41,8 @@ Literal::Literal(const Literal& other)
       break;
     default:
       Assert (isSymbol(d_kind));
-      new (&d_sym) std::string;
       d_sym = other.d_sym;
+      StringPool::get().addRef(d_sym);
       break;
   }
 }
@@ -51,6 +51,7 @@ Literal& Literal::operator=(const Literal& other)
 {
   if (this != &other)
   {
+    destroyValue();
     d_kind = other.d_kind;
     switch (d_kind)
     {
@@ -77,14 +78,35 @@ Literal& Literal::operator=(const Literal& other)
         break;
       default:
         Assert (isSymbol(d_kind));
-        new (&d_sym) std::string;
         d_sym = other.d_sym;
+        StringPool::get().addRef(d_sym);
         break;
     }
   }
   return *this;
 }
 
+Literal::~Literal() { destroyValue(); }
+
+void Literal::destroyValue()
+{
+  switch (d_kind)
+  {
+    case Kind::DECIMAL:
+    case Kind::RATIONAL: d_rat.~Rational(); break;
+    case Kind::NUMERAL: d_int.~Integer(); break;
+    case Kind::HEXADECIMAL:
+    case Kind::BINARY: d_bv.~BitVector(); break;
+    case Kind::STRING: d_str.~String(); break;
+    default:
+      if (isSymbol(d_kind))
+      {
+        StringPool::get().release(d_sym);
+      }
+      break;
+  }
+}
+
 std::string Literal::toString() const
 {
   switch (d_kind)
@@ -104,7 +126,7 @@ std::string Literal::toString() const
     case Kind::NONE: break;
     default:
       Assert(isSymbol(d_kind));
-      return d_sym;
+      return StringPool::get().getString(d_sym);
       break;
   }
   EO_FATAL() << "Cannot convert literal to string " << d_kind;
@@ -397,14 +419,14 @@ Literal Literal::evaluate(Kind k, const std::vector<const Literal*>& args)
         case Kind::DECIMAL:
         case Kind::RATIONAL:return Literal(args[0]->d_rat.floor());
         case Kind::NUMERAL: return *args[0];
-        case Kind::BINARY:return Literal(args[0]->d_bv.getValue());
+        case Kind::BINARY:return Literal(args[0]->d_bv.toInteger());
         case Kind::STRING:
         {
           // if a string of length one, we return the code point of the
           // character
           if (args[0]->d_str.size()==1)
           {
-            return Literal(Integer(args[0]->d_str.getVec()[0]));
+            return Literal(Integer(args[0]->d_str[0]));
           }
         }
           break;
@@ -428,7 +450,7 @@ Literal Literal::evaluate(Kind k, const std::vector<const Literal*>& args)
         {
           case Kind::NUMERAL:return Literal(Kind::BINARY, BitVector(size, args[1]->d_int));
           case Kind::HEXADECIMAL:
-          case Kind::BINARY:return Literal(Kind::BINARY, BitVector(size, args[1]->d_bv.getValue()));
+          case Kind::BINARY:return Literal(Kind::BINARY, BitVector(size, args[1]->d_bv.toInteger()));
           default: break;
         }
       }
@@ -17,6 +17,7 @@
 #include "util/string.h"
 #include "kind.h"
 #include "expr.h"
+#include "string_pool.h"
 
 namespace ethos {
 
@@ -31,27 +32,35 @@ public:
     Rational d_rat;
     BitVector d_bv;
     String d_str;
-    std::string d_sym;
+    /** The name of a symbol, interned in the string pool */
+    StringId d_sym;
   };
 
   Literal(const Literal& other);
   Literal() {}
-  Literal(bool b) : ExprValue(Kind::BOOLEAN, {}), d_bool(b) {}
-  Literal(const Integer& i) : ExprValue(Kind::NUMERAL, {}), d_int(i) {}
-  Literal(Kind k, const Rational& r) : ExprValue(k, {}), d_rat(r) {}
-  Literal(Kind k, const BitVector& bv) : ExprValue(k, {}), d_bv(bv) {}
-  Literal(const String& str) : ExprValue(Kind::STRING, {}), d_str(str) {}
-  Literal(Kind k, const std::string& sym) : ExprValue(k, {}), d_sym(sym) {}
+  Literal(bool b) : ExprValue(Kind::BOOLEAN), d_bool(b) {}
+  Literal(const Integer& i) : ExprValue(Kind::NUMERAL), d_int(i) {}
+  Literal(Kind k, const Rational& r) : ExprValue(k), d_rat(r) {}
+  Literal(Kind k, const BitVector& bv) : ExprValue(k), d_bv(bv) {}
+  Literal(const String& str) : ExprValue(Kind::STRING), d_str(str) {}
+  Literal(Kind k, const std::string& sym)
+      : ExprValue(k), d_sym(StringPool::get().intern(sym))
+  {
+  }
 
   Literal& operator=(const Literal& other);
 
-  ~Literal() {}
+  ~Literal();
   /** as literal */
   const Literal* asLiteral() const override { return this; }
   std::string toString() const;
 
   /** Evaluate literal op */
   static Literal evaluate(Kind k, const std::vector<const Literal*>& args);
+
+ private:
+  /** Destroy the member of the union that is in use, as given by the kind */
+  void destroyValue();
 };
 
 }  // namespace ethos
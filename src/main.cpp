@@ -8,12 +8,16 @@
  ******************************************************************************/
 
 #include <unistd.h>
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
 #include <iomanip>
 #include <iostream>
 
 #include "base/check.h"
 #include "base/output.h"
 #include "parser.h"
+#include "plugin_loader.h"
 #include "state.h"
 
 using namespace ethos;
@@ -27,11 +31,34 @@ int main( int argc, char* argv[] )
   std::string file;
   bool readFile = false;
   size_t nargs = static_cast<size_t>(argc);
+  std::string pluginFile;
   while (i<nargs)
   {
     std::string arg(argv[i]);
     i++;
-    if (arg.compare(0, 5, "--no-") == 0)
+    size_t eq = arg.find('=');
+    if (arg.compare(0, 2, "--") == 0 && eq != std::string::npos)
+    {
+      std::string key = arg.substr(2, eq - 2);
+      if (Options::isNumericOption(key))
+      {
+        std::string val = arg.substr(eq + 1);
+        if (val.empty() || val.find_first_not_of("0123456789") != std::string::npos)
+        {
+          EO_FATAL() << "Error: expected a numeral value for option " << key;
+        }
+        errno = 0;
+        unsigned long long nval = std::strtoull(val.c_str(), nullptr, 10);
+        // the numeric options are in megabytes, which must fit in a size_t
+        if (errno == ERANGE || nval > (SIZE_MAX >> 20))
+        {
+          EO_FATAL() << "Error: value too large for option " << key;
+        }
+        opts.setNumericOption(key, static_cast<size_t>(nval));
+        continue;
+      }
+    }
+    else if (arg.compare(0, 5, "--no-") == 0)
     {
       if (opts.setOption(arg.substr(5), false))
       {
@@ -48,19 +75,24 @@ int main( int argc, char* argv[] )
     if (arg == "--help")
     {
       std::stringstream out;
-      out << "     --binder-fresh: binders generate fresh variables when parsed in proof files." << std::endl;
-      out << "             --help: displays this message." << std::endl;
-      out << "    --normalize-num: treat numeral literals as syntax sugar for rational literals." << std::endl;
-      out << " --no-normalize-dec: do not treat decimal literals as syntax sugar for rational literals." << std::endl;
-      out << " --no-normalize-hex: do not treat hexadecimal literals as syntax sugar for binary literals." << std::endl;
-      out << "     --no-parse-let: do not treat let as a builtin symbol for specifying terms having shared subterms." << std::endl;
-      out << "     --no-print-let: do not letify the output of terms in error messages and trace messages." << std::endl;
-      out << "--no-rule-sym-table: do not use a separate symbol table for proof rules and declared terms." << std::endl;
-      out << "      --show-config: displays the build information for this binary." << std::endl;
-      out << "            --stats: enables detailed statistics." << std::endl;
-      out << "    --stats-compact: print statistics in a compact format." << std::endl;
-      out << "           -t <tag>: enables the given trace tag (requires debug build)." << std::endl;
-      out << "                 -v: verbose mode, enable all standard trace messages (requires debug build)." << std::endl;
+      out << "      --binder-fresh: binders generate fresh variables when parsed in proof files." << std::endl;
+      out << "    --bytecode-match: match program cases and argument types using patterns compiled to a bytecode." << std::endl;
+      out << "--eval-cache-limit=N: limit each cache of program evaluations, overloads and application types to N megabytes (default 64), 0 disables them." << std::endl;
+      out << "             --no-gc: do not delete terms that are no longer referenced, which is faster for one-shot runs." << std::endl;
+      out << "     --no-gc-limit=N: if --no-gc is used, delete the terms made after the memory use exceeds N megabytes (default 4096), 0 for no limit." << std::endl;
+      out << "              --help: displays this message." << std::endl;
+      out << "     --normalize-num: treat numeral literals as syntax sugar for rational literals." << std::endl;
+      out << "  --no-normalize-dec: do not treat decimal literals as syntax sugar for rational literals." << std::endl;
+      out << "  --no-normalize-hex: do not treat hexadecimal literals as syntax sugar for binary literals." << std::endl;
+      out << "      --no-parse-let: do not treat let as a builtin symbol for specifying terms having shared subterms." << std::endl;
+      out << "     --plugin <file>: load a plugin from the given shared object." << std::endl;
+      out << "      --no-print-let: do not letify the output of terms in error messages and trace messages." << std::endl;
+      out << " --no-rule-sym-table: do not use a separate symbol table for proof rules and declared terms." << std::endl;
+      out << "       --show-config: displays the build information for this binary." << std::endl;
+      out << "             --stats: enables detailed statistics." << std::endl;
+      out << "     --stats-compact: print statistics in a compact format." << std::endl;
+      out << "            -t <tag>: enables the given trace tag (requires debug build)." << std::endl;
+      out << "                  -v: verbose mode, enable all standard trace messages (requires debug build)." << std::endl;
       std::cout << out.str();
       return 0;
     }
@@ -75,11 +107,31 @@ int main( int argc, char* argv[] )
       out << "yes";
 #else
       out << "no";
+#endif
+      out << std::endl;
+      out << std::setw(w) << "plugins : ";
+#ifdef EO_PLUGINS
+      out << "yes";
+#else
+      out << "no";
 #endif
       out << std::endl;
       std::cout << out.str();
       return 0;
     }
+    else if (arg=="--plugin")
+    {
+      if (i >= nargs)
+      {
+        EO_FATAL() << "Error: expected a file for option --plugin";
+      }
+#ifdef EO_PLUGINS
+      pluginFile = argv[i];
+      i++;
+#else
+      EO_FATAL() << "Error: plugins not enabled in this build";
+#endif
+    }
     else if (arg=="-t")
     {
       std::string targ(argv[i]);
@@ -125,7 +177,17 @@ int main( int argc, char* argv[] )
   }
   State s(opts, stats);
   Plugin * plugin = nullptr;
-  // NOTE: initialization of plugin goes here
+#ifdef EO_PLUGINS
+  if (!pluginFile.empty())
+  {
+    std::string err;
+    plugin = loadPlugin(pluginFile, s, err);
+    if (plugin == nullptr)
+    {
+      EO_FATAL() << "Error: cannot load plugin " << pluginFile << ": " << err;
+    }
+  }
+#endif
   if (plugin!=nullptr)
   {
     s.setPlugin(plugin);
@@ -140,7 +202,11 @@ int main( int argc, char* argv[] )
     // parse from std::cin.
     // we assume this is a proof (not signature, not reference)
     Parser p(s, false, false);
-    p.setStreamInput(std::cin);
+    // Since std::cin is not a terminal, it is read in blocks. We do not mix
+    // C and C++ I/O on it, so it need not be synchronized with stdio, which
+    // would otherwise make reads from it unbuffered.
+    std::ios_base::sync_with_stdio(false);
+    p.setStreamInput(std::cin, false);
     // parse commands until finished
     while (p.parseNextCommand())
     {
@@ -24,9 +24,9 @@ void Parser::setFileInput(const std::string& filename)
   d_lex.initialize(d_input.get(), filename);
 }
 
-void Parser::setStreamInput(std::istream& input)
+void Parser::setStreamInput(std::istream& input, bool interactive)
 {
-  d_input = Input::mkStreamInput(input);
+  d_input = Input::mkStreamInput(input, interactive);
   d_lex.initialize(d_input.get(), "stream");
 }
 
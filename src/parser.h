@@ -41,8 +41,9 @@ class Parser
   /** Set the input for the given stream.
    *
    * @param input the input stream
+   * @param interactive whether the stream is interactive
    */
-  void setStreamInput(std::istream& input);
+  void setStreamInput(std::istream& input, bool interactive = true);
   /** Set the string input for the given file.
    *
    * @param filename the input
@@ -18,6 +18,8 @@
 
 namespace ethos {
 
+class State;
+
 /**
  * A plugin class. This is a virtual base class that receives callbacks from
  * the core of the EO checker.
@@ -134,6 +136,14 @@ public:
   virtual void finalize() {}
 };
 
+/**
+ * The name of the function that a plugin compiled as a shared object must
+ * define with C linkage, of type PluginFactory. It constructs the plugin for
+ * the given state, see loadPlugin.
+ */
+#define EO_PLUGIN_FACTORY "ethos_create_plugin"
+using PluginFactory = Plugin* (*)(State& s);
+
 }  // namespace ethos
 
 #endif /* STATE_H */
@@ -0,0 +1,53 @@
+/******************************************************************************
+ * This file is part of the ethos project.
+ *
+ * Copyright (c) 2023-2024 by the authors listed in the file AUTHORS
+ * in the top-level source directory and their institutional affiliations.
+ * All rights reserved.  See the file COPYING in the top-level source
+ * directory for licensing information.
+ ******************************************************************************/
+
+#ifdef EO_PLUGINS
+
+#include "plugin_loader.h"
+
+#include <dlfcn.h>
+
+#include "base/output.h"
+
+namespace ethos {
+
+Plugin* loadPlugin(const std::string& path, State& s, std::string& err)
+{
+  // a plain file name would be searched for in the library path
+  std::string lpath = path.find('/') == std::string::npos ? "./" + path : path;
+  void* handle = dlopen(lpath.c_str(), RTLD_NOW | RTLD_LOCAL);
+  if (handle == nullptr)
+  {
+    err = dlerror();
+    return nullptr;
+  }
+  // clear any previous error
+  dlerror();
+  void* sym = dlsym(handle, EO_PLUGIN_FACTORY);
+  const char* serr = dlerror();
+  if (serr != nullptr || sym == nullptr)
+  {
+    err = serr != nullptr ? serr : "null symbol " EO_PLUGIN_FACTORY;
+    dlclose(handle);
+    return nullptr;
+  }
+  Trace("plugin") << "Loaded plugin " << path << std::endl;
+  PluginFactory factory = reinterpret_cast<PluginFactory>(sym);
+  Plugin* p = factory(s);
+  if (p == nullptr)
+  {
+    err = EO_PLUGIN_FACTORY " returned null";
+    dlclose(handle);
+  }
+  return p;
+}
+
+}  // namespace ethos
+
+#endif /* EO_PLUGINS */
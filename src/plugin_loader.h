@@ -0,0 +1,36 @@
+/******************************************************************************
+ * This file is part of the ethos project.
+ *
+ * Copyright (c) 2023-2024 by the authors listed in the file AUTHORS
+ * in the top-level source directory and their institutional affiliations.
+ * All rights reserved.  See the file COPYING in the top-level source
+ * directory for licensing information.
+ ******************************************************************************/
+#ifndef PLUGIN_LOADER_H
+#define PLUGIN_LOADER_H
+
+#ifdef EO_PLUGINS
+
+#include <string>
+
+#include "plugin.h"
+
+namespace ethos {
+
+/**
+ * Load the plugin from the shared object at the given path, e.g. one built by
+ * contrib/ethos_build_plugin.
+ *
+ * The shared object must define the function named EO_PLUGIN_FACTORY, which
+ * is called to construct the plugin for state s. The shared object remains
+ * loaded for the remainder of the run.
+ *
+ * @return The plugin, or nullptr if it could not be loaded, in which case
+ * an error message is written on err.
+ */
+Plugin* loadPlugin(const std::string& path, State& s, std::string& err);
+
+}  // namespace ethos
+
+#endif /* EO_PLUGINS */
+#endif /* PLUGIN_LOADER_H */
@@ -8,12 +8,14 @@
  ******************************************************************************/
 #include "state.h"
 
+#include <cstdint>
 #include <iostream>
 
 #include "base/check.h"
 #include "base/output.h"
 #include "parser.h"
 #include "util/filesystem.h"
+#include "util/memory.h"
 
 namespace ethos {
 
@@ -28,6 +30,10 @@ Options::Options()
   d_normalizeHexadecimal = true;
   d_normalizeNumeral = false;
   d_binderFresh = false;
+  d_bytecodeMatch = false;
+  d_evalCacheLimit = 64;
+  d_gc = true;
+  d_noGcLimit = 4096;
 }
 
 bool Options::setOption(const std::string& key, bool val)
@@ -73,6 +79,14 @@ bool Options::setOption(const std::string& key, bool val)
   {
     d_normalizeHexadecimal = val;
   }
+  else if (key == "bytecode-match")
+  {
+    d_bytecodeMatch = val;
+  }
+  else if (key == "gc")
+  {
+    d_gc = val;
+  }
   else
   {
     return false;
@@ -82,16 +96,58 @@ bool Options::setOption(const std::string& key, bool val)
   return true;
 }
 
+bool Options::setNumericOption(const std::string& key, size_t val)
+{
+  if (key == "eval-cache-limit")
+  {
+    d_evalCacheLimit = val;
+  }
+  else if (key == "no-gc-limit")
+  {
+    d_noGcLimit = val;
+  }
+  else
+  {
+    return false;
+  }
+  Trace("options") << "setNumericOption(\"" << key << "\", " << val << ")"
+                   << std::endl;
+  return true;
+}
+
+bool Options::isNumericOption(const std::string& key)
+{
+  return key == "eval-cache-limit" || key == "no-gc-limit";
+}
+
 State::State(Options& opts, Stats& stats)
-    : d_hashCounter(0),
+    : d_appData(1),
+      d_hashMap(1, 0),
+      d_typeCache(1),
+      d_hashCounter(0),
       d_hasReference(false),
       d_inGarbageCollection(false),
+      d_mkImmortal(true),
+      d_noGcLimitExceeded(false),
+      d_noGcCheckSlabs(0),
       d_tc(*this, opts),
+      d_evalCache(stats.d_evalCacheHit,
+                  stats.d_evalCacheMiss,
+                  stats.d_evalCacheEvict),
+      d_overloadCache(stats.d_overloadCacheHit,
+                      stats.d_overloadCacheMiss,
+                      stats.d_overloadCacheEvict),
+      d_typeAppCache(stats.d_typeAppCacheHit,
+                     stats.d_typeAppCacheMiss,
+                     stats.d_typeAppCacheEvict),
       d_opts(opts),
       d_stats(stats),
       d_plugin(nullptr)
 {
   ExprValue::d_state = this;
+  d_evalCache.setLimit(opts.d_evalCacheLimit * 1024 * 1024);
+  d_overloadCache.setLimit(opts.d_evalCacheLimit * 1024 * 1024);
+  d_typeAppCache.setLimit(opts.d_evalCacheLimit * 1024 * 1024);
   d_absType = Expr(mkExprInternal(Kind::ABSTRACT_TYPE, {}));
 
   // lambda is not builtin?
@@ -164,10 +220,11 @@ State::State(Options& opts, Stats& stats)
   // common constants
   d_type = Expr(mkExprInternal(Kind::TYPE, {}));
   d_boolType = Expr(mkExprInternal(Kind::BOOL_TYPE, {}));
-  d_true = Expr(new Literal(true));
+  d_true = Expr(newLiteral(true));
   bind("true", d_true);
-  d_false = Expr(new Literal(false));
+  d_false = Expr(newLiteral(false));
   bind("false", d_false);
+  d_mkImmortal = false;
 }
 
 State::~State() {}
@@ -177,8 +234,11 @@ void State::reset()
   d_symTable.clear();
   d_assumptions.clear();
   d_assumptionsSizeCtx.clear();
-  d_decls.clear();
-  d_declsSizeCtx.clear();
+  d_overloadedDecls.clear();
+  d_overloadedDeclsSizeCtx.clear();
+  d_evalCache.clear();
+  d_overloadCache.clear();
+  d_typeAppCache.clear();
   if (d_plugin!=nullptr)
   {
     d_plugin->reset();
@@ -187,7 +247,8 @@ void State::reset()
 
 void State::pushScope()
 {
-  d_declsSizeCtx.push_back(d_decls.size());
+  d_symTable.pushScope();
+  d_overloadedDeclsSizeCtx.push_back(d_overloadedDecls.size());
   if (d_plugin!=nullptr)
   {
     d_plugin->pushScope();
@@ -200,36 +261,36 @@ void State::popScope()
   {
     d_plugin->popScope();
   }
-  if (d_declsSizeCtx.empty())
+  if (d_overloadedDeclsSizeCtx.empty())
   {
     EO_FATAL() << "State::popScope: empty context";
   }
-  size_t lastSize = d_declsSizeCtx.back();
-  d_declsSizeCtx.pop_back();
-  for (size_t i=lastSize, currSize = d_decls.size(); i<currSize; i++)
+  size_t lastSize = d_overloadedDeclsSizeCtx.back();
+  d_overloadedDeclsSizeCtx.pop_back();
+  // Remove the overloads added in this scope. Overloading does not change
+  // the binding of a symbol, so this is independent of the symbol table.
+  while (d_overloadedDecls.size() > lastSize)
   {
-    // Check if overloaded, which is the case if the last overloaded
-    // declaration had the same name.
-    if (!d_overloadedDecls.empty() && d_overloadedDecls.back()==d_decls[i])
+    AppInfo* ai = getAppInfo(d_overloadedDecls.back().getValue());
+    Assert (ai!=nullptr);
+    Assert (!ai->d_overloads.empty());
+    if (hasQuotedArgument(ai->d_overloads.back()))
     {
-      d_overloadedDecls.pop_back();
-      // it should be overloaded
-      AppInfo* ai = getAppInfo(d_symTable[d_decls[i]].getValue());
-      Assert (ai!=nullptr);
-      Assert (!ai->d_overloads.empty());
-      ai->d_overloads.pop_back();
-      if (ai->d_overloads.size()==1)
-      {
-        Trace("overload") << "** no-overload: " << d_decls[i] << std::endl;
-        // no longer overloaded since the overload vector is now size one
-        ai->d_overloads.clear();
-      }
-      // was overloaded, so we don't unbind
-      continue;
+      Assert(ai->d_numQuotedOverloads > 0);
+      ai->d_numQuotedOverloads--;
+    }
+    ai->d_overloads.pop_back();
+    if (ai->d_overloads.size()==1)
+    {
+      Trace("overload") << "** no-overload: " << d_overloadedDecls.back()
+                        << std::endl;
+      // no longer overloaded since the overload vector is now size one
+      ai->d_overloads.clear();
+      ai->d_numQuotedOverloads = 0;
     }
-    d_symTable.erase(d_decls[i]);
+    d_overloadedDecls.pop_back();
   }
-  d_decls.resize(lastSize);
+  d_symTable.popScope();
 }
 
 void State::pushAssumptionScope()
@@ -282,6 +343,10 @@ bool State::includeFile(const std::string& s, bool isSignature, bool isReference
   d_referenceNf = referenceNf;
   Filepath currentPath = d_inputFile;
   d_inputFile = inputPath;
+  // terms of signatures included by another file are immortal, whereas the
+  // file given on the command line may contain proofs
+  bool prevImmortal = d_mkImmortal;
+  d_mkImmortal = isSignature && !currentPath.getRawPath().empty();
   if (d_plugin!=nullptr)
   {
     Assert (!isReference);
@@ -298,6 +363,7 @@ bool State::includeFile(const std::string& s, bool isSignature, bool isReference
   }
   while (parsedCommand);
   d_inputFile = currentPath;
+  d_mkImmortal = prevImmortal;
   Trace("state") << "...finished" << std::endl;
   if (getAssumptionLevel()!=0)
   {
@@ -369,35 +435,37 @@ void State::markDeleted(ExprValue* e)
       }
         break;
       default:
-      {
-        if (isSymbol(k))
-        {
-          std::map<const ExprValue*, AppInfo>::const_iterator it = d_appData.find(e);
-          if (it != d_appData.end())
-          {
-            d_appData.erase(it);
-          }
-        }
-      }
       break;
     }
-    std::map<const ExprValue*, size_t>::const_iterator ith = d_hashMap.find(e);
-    if (ith != d_hashMap.end())
+    // clear the side tables and recycle the identifier
+    uint32_t id = e->d_id;
+    Assert(id != 0 && id < d_typeCache.size());
+    d_appData[id].reset();
+    d_hashMap[id] = 0;
+    d_typeCache[id] = d_null;
+    d_freeIds.push_back(id);
+    // remove from the expression table, literals and symbols are not stored
+    // there
+    if (e->asLiteral() == nullptr)
     {
-      d_hashMap.erase(ith);
+      d_table.remove(e);
     }
-    std::map<const ExprValue*, Expr>::const_iterator itt = d_typeCache.find(e);
-    if (itt != d_typeCache.end())
+    if (e->getFlag(ExprValue::Flag::IS_LIST_CACHED))
     {
-      d_typeCache.erase(itt);
+      d_listCache.erase(e);
     }
-    // remove from the expression trie
-    ExprTrie* et = &d_trie[e->getKind()];
-    Assert(et != nullptr);
-    const std::vector<ExprValue*>& children = e->d_children;
-    et->remove(children);
     // now, free the expression
-    free(e);
+    if (e->asLiteral() == nullptr)
+    {
+      d_arena.deallocate(e, ExprValue::getAllocSize(e->getNumChildren()));
+    }
+    else
+    {
+      // free the storage of its value, e.g. a large integer or string
+      Literal* l = static_cast<Literal*>(e);
+      l->~Literal();
+      d_arena.deallocate(l, sizeof(Literal));
+    }
     if (!d_toDelete.empty())
     {
       e = d_toDelete.back();
@@ -590,17 +658,23 @@ ExprValue* State::mkSymbolInternal(Kind k,
   d_stats.d_symCount++;
   d_stats.d_exprCount++;
   std::vector<ExprValue*> emptyVec;
-  ExprValue* v = new Literal(k, name);
+  ExprValue* v = newLiteral(k, name);
   // immediately set its type
-  d_typeCache[v] = type;
+  d_typeCache[v->d_id] = type;
   Trace("type_checker") << "TYPE " << name << " : " << type << std::endl;
   //d_symcMap[key] = v;
   return v;
 }
 
-Expr State::mkExpr(Kind k, const std::vector<Expr>& children)
+Expr State::mkExpr(Kind k, std::initializer_list<Expr> children)
+{
+  return mkExpr(k, ArrayView<Expr>(children.begin(), children.size()));
+}
+
+Expr State::mkExpr(Kind k, ArrayView<Expr> children)
 {
   std::vector<ExprValue*> vchildren;
+  vchildren.reserve(children.size());
   for (const Expr& c : children)
   {
     vchildren.push_back(c.getValue());
@@ -631,14 +705,15 @@ Expr State::mkExpr(Kind k, const std::vector<Expr>& children)
           return mkParameterized(vchildren[1], achildren);
         }
         // another builtin operator, possibly APPLY
-        std::vector<Expr> achildren(children.begin()+1, children.end());
+        ArrayView<Expr> achildren(children.data()+1, children.size()-1);
         // must call mkExpr again, since we may auto-evaluate
         return mkExpr(ai->d_kind, achildren);
       }
       if (!ai->d_overloads.empty())
       {
         Trace("overload") << "Use overload when constructing " << k << " " << children << std::endl;
-        Expr ret = getOverloadInternal(ai->d_overloads, children);
+        Expr ret = getOverloadInternal(
+            ai->d_overloads, children, ai->d_numQuotedOverloads == 0);
         if (!ret.isNull())
         {
           vchildren[0] = ret.getValue();
@@ -787,7 +862,7 @@ Expr State::mkExpr(Kind k, const std::vector<Expr>& children)
           }
           else
           {
-            std::vector<Expr> ochildren(children.begin(), children.begin()+1+nargs);
+            ArrayView<Expr> ochildren(children.data(), 1+nargs);
             Expr op = mkExpr(Kind::APPLY_OPAQUE, ochildren);
             Trace("opaque") << "Construct opaque operator " << op << std::endl;
             if (nargs+1==children.size())
@@ -811,7 +886,7 @@ Expr State::mkExpr(Kind k, const std::vector<Expr>& children)
     if (hk==Kind::LAMBDA)
     {
       // beta-reduce eagerly, if the correct arity
-      const std::vector<ExprValue*>& vars = (*hd)[0]->getChildren();
+      ArrayView<ExprValue*> vars = (*hd)[0]->getChildren();
       size_t nvars = vars.size();
       if (nvars==children.size()-1)
       {
@@ -905,12 +980,12 @@ Expr State::mkExpr(Kind k, const std::vector<Expr>& children)
       if (ai!=nullptr && !ai->d_overloads.empty())
       {
         Trace("overload") << "...overloaded" << std::endl;
-        reto = getOverloadInternal(ai->d_overloads, dummyChildren, ftype.second.getValue());
+        reto = getOverloadInternal(ai->d_overloads, dummyChildren, ai->d_numQuotedOverloads == 0, ftype.second.getValue());
       }
       else
       {
         Trace("overload") << "...not overloaded" << std::endl;
-        reto = getOverloadInternal({children[0]}, dummyChildren, ftype.second.getValue());
+        reto = getOverloadInternal(ArrayView<Expr>(children.data(), 1), dummyChildren, !hasQuotedArgument(children[0]), ftype.second.getValue());
       }
       if (!reto.isNull())
       {
@@ -976,7 +1051,7 @@ ExprValue* State::mkLiteralInternal(Literal& l)
       {
         return it->second.getValue();
       }
-      ev = new Literal(l.d_int);
+      ev = newLiteral(l.d_int);
       d_litIntMap[l.d_int] = Expr(ev);
     }
       break;
@@ -990,7 +1065,7 @@ ExprValue* State::mkLiteralInternal(Literal& l)
       {
         return it->second.getValue();
       }
-      ev = new Literal(k, l.d_rat);
+      ev = newLiteral(k, l.d_rat);
       m[l.d_rat] = Expr(ev);
     }
       break;
@@ -1004,7 +1079,7 @@ ExprValue* State::mkLiteralInternal(Literal& l)
       {
         return it->second.getValue();
       }
-      ev = new Literal(k, l.d_bv);
+      ev = newLiteral(k, l.d_bv);
       m[l.d_bv] = Expr(ev);
     }
       break;
@@ -1015,7 +1090,7 @@ ExprValue* State::mkLiteralInternal(Literal& l)
       {
         return it->second.getValue();
       }
-      ev = new Literal(l.d_str);
+      ev = newLiteral(l.d_str);
       d_litStrMap[l.d_str] = Expr(ev);
     }
       break;
@@ -1044,16 +1119,27 @@ ExprValue* State::mkExprInternal(Kind k,
                                  const std::vector<ExprValue*>& children)
 {
   d_stats.d_mkExprCount++;
-  ExprTrie* et = &d_trie[k];
-  et = et->get(children);
-  if (et->d_data!=nullptr)
+  size_t h = ExprTable::computeHash(k, children);
+  size_t slot = 0;
+  size_t probes = 0;
+  ExprValue* ev = d_table.find(k, children, h, slot, probes);
+  d_stats.d_exprProbeCount += probes;
+  if (probes > d_stats.d_exprProbeMax)
   {
-    return et->d_data;
+    d_stats.d_exprProbeMax = probes;
+  }
+  if (ev != nullptr)
+  {
+    return ev;
   }
   d_stats.d_exprCount++;
-  ExprValue* ev = new ExprValue(k, children);
+  void* mem = d_arena.allocate(ExprValue::getAllocSize(children.size()));
+  ev = new (mem) ExprValue(k, children);
+  ev->d_hash = h;
+  assignId(ev);
+  setImmortal(ev);
   Trace("gc") << "New " << ev << " " << k << std::endl;
-  et->d_data = ev;
+  d_table.insert(slot, ev);
   return ev;
 }
 
@@ -1068,52 +1154,51 @@ bool State::bind(const std::string& name, const Expr& e)
   if (d_opts.d_ruleSymTable && e.getKind() == Kind::PROOF_RULE)
   {
     // don't bind at non-global scope
-    Assert (d_declsSizeCtx.empty());
-    if (d_ruleSymTable.find(name)!=d_ruleSymTable.end())
+    Assert (d_symTable.getLevel()==0);
+    if (!d_ruleSymTable.lookup(name).isNull())
     {
       return false;
     }
-    d_ruleSymTable[name] = e;
+    d_ruleSymTable.bind(name, e);
     return true;
   }
   // otherwise use the main symbol table
-  std::map<std::string, Expr>::iterator its = d_symTable.find(name);
-  if (its!=d_symTable.end())
+  const Expr& prev = d_symTable.lookup(name);
+  if (!prev.isNull())
   {
     // if already bound, we overload
-    AppInfo& ai = d_appData[its->second.getValue()];
+    AppInfo& ai = getOrMkAppInfo(prev.getValue());
     // if the first time overloading, add the original
     if (ai.d_overloads.empty())
     {
       Trace("overload") << "** overload: " << name << std::endl;
-      ai.d_overloads.push_back(its->second);
+      ai.d_overloads.push_back(prev);
+      ai.d_numQuotedOverloads = hasQuotedArgument(prev) ? 1 : 0;
     }
     ai.d_overloads.push_back(e);
-    // add to declaration
-    if (!d_declsSizeCtx.empty())
+    if (hasQuotedArgument(e))
+    {
+      ai.d_numQuotedOverloads++;
+    }
+    // only have to remember if not at global scope
+    if (d_symTable.getLevel()>0)
     {
-      d_decls.emplace_back(name);
-      d_overloadedDecls.emplace_back(name);
+      d_overloadedDecls.push_back(prev);
     }
     return true;
   }
   // Trace("state-debug") << "bind " << name << " -> " << &e << std::endl;
-  d_symTable[name] = e;
-  // only have to remember if not at global scope
-  if (!d_declsSizeCtx.empty())
-  {
-    d_decls.emplace_back(name);
-  }
+  d_symTable.bind(name, e);
   return true;
 }
 
 Expr State::mkBinderList(const ExprValue* ev, const std::vector<Expr>& vs)
 {
   Assert (!vs.empty());
-  std::map<const ExprValue *, AppInfo>::const_iterator it = d_appData.find(ev);
-  Assert (it!=d_appData.end());
+  const AppInfo* ai = getAppInfo(ev);
+  Assert(ai != nullptr);
   std::vector<Expr> vlist;
-  vlist.push_back(it->second.d_attrConsTerm);
+  vlist.push_back(ai->d_attrConsTerm);
   vlist.insert(vlist.end(), vs.begin(), vs.end());
   return mkExpr(Kind::APPLY, vlist);
 }
@@ -1121,9 +1206,9 @@ Expr State::mkBinderList(const ExprValue* ev, const std::vector<Expr>& vs)
 Expr State::mkLetBinderList(const ExprValue* ev, const std::vector<std::pair<Expr, Expr>>& lls)
 {
   Assert (!lls.empty());
-  std::map<const ExprValue *, AppInfo>::const_iterator it = d_appData.find(ev);
-  Assert (it!=d_appData.end());
-  Expr cons = it->second.d_attrConsTerm;
+  const AppInfo* ai = getAppInfo(ev);
+  Assert(ai != nullptr);
+  Expr cons = ai->d_attrConsTerm;
   Assert (cons.getKind()==Kind::TUPLE && cons.getNumChildren()==2);
   Expr pairCons = cons[0];
   Expr listCons = cons[1];
@@ -1160,36 +1245,35 @@ Attr State::getConstructorKind(const ExprValue* v) const
 
 Expr State::getVar(const std::string& name) const
 {
-  std::map<std::string, Expr>::const_iterator it = d_symTable.find(name);
-  if (it!=d_symTable.end())
-  {
-    return it->second;
-  }
-  return d_null;
+  return d_symTable.lookup(name);
 }
 
 Expr State::getBoundVar(const std::string& name, const Expr& type)
 {
-  std::pair<std::string, const ExprValue*> key(name, type.getValue());
-  std::map<std::pair<std::string, const ExprValue*>, Expr>::iterator it = d_boundVars.find(key);
-  if (it!=d_boundVars.end())
+  std::pair<StringId, const ExprValue*> key(0, type.getValue());
+  // if the name is not in the pool, there is no bound variable for it
+  if (StringPool::get().find(name, key.first))
   {
-    return it->second;
+    std::unordered_map<std::pair<StringId, const ExprValue*>,
+                       Expr,
+                       BoundVarHashFunction>::iterator it =
+        d_boundVars.find(key);
+    if (it != d_boundVars.end())
+    {
+      return it->second;
+    }
   }
   Expr ret = mkSymbol(Kind::VARIABLE, name, type);
+  // the variable holds the reference to its name
+  key.first = ret.getValue()->asLiteral()->d_sym;
   d_boundVars[key] = ret;
   return ret;
 }
 
 Expr State::getProofRule(const std::string& name) const
 {
-  const std::map<std::string, Expr>& t = d_opts.d_ruleSymTable ? d_ruleSymTable : d_symTable;
-  std::map<std::string, Expr>::const_iterator it = t.find(name);
-  if (it!=t.end())
-  {
-    return it->second;
-  }
-  return d_null;
+  const SymbolTable& t = d_opts.d_ruleSymTable ? d_ruleSymTable : d_symTable;
+  return t.lookup(name);
 }
 
 bool State::getActualPremises(const ExprValue* rule,
@@ -1241,7 +1325,7 @@ bool State::getActualPremises(const ExprValue* rule,
       return true;
     }
   }
-  actual = given;
+  actual = std::move(given);
   return true;
 }
 
@@ -1254,6 +1338,65 @@ Expr State::getProgram(const ExprValue* ev)
   }
   return d_null;
 }
+
+const CaseIndex* State::getCaseIndex(const ExprValue* ev)
+{
+  AppInfo* ainfo = getAppInfo(ev);
+  if (ainfo != nullptr)
+  {
+    return ainfo->d_caseIndex.get();
+  }
+  return nullptr;
+}
+
+const std::vector<std::unique_ptr<CompiledPattern>>&
+State::getCompiledProgram(const ExprValue* ev)
+{
+  AppInfo& ainfo = getOrMkAppInfo(ev);
+  Assert(ainfo.d_attrCons == Attr::PROGRAM);
+  if (ainfo.d_compiledCases.empty())
+  {
+    const Expr& prog = ainfo.d_attrConsTerm;
+    for (size_t i = 0, ncases = prog.getNumChildren(); i < ncases; i++)
+    {
+      // compile the arguments of the case, programs only evaluate on ground
+      // arguments
+      ArrayView<ExprValue*> pat = prog[i][0].getValue()->getChildren();
+      std::vector<ExprValue*> pats(pat.begin() + 1, pat.end());
+      ainfo.d_compiledCases.emplace_back(new CompiledPattern(pats, true));
+    }
+  }
+  return ainfo.d_compiledCases;
+}
+
+const CompiledPattern* State::getCompiledFunctionType(const ExprValue* ft)
+{
+  Assert(ft->getKind() == Kind::FUNCTION_TYPE);
+  AppInfo& ainfo = getOrMkAppInfo(ft);
+  if (!ainfo.d_hasCompiledArgTypes)
+  {
+    ainfo.d_hasCompiledArgTypes = true;
+    std::vector<ExprValue*> pats;
+    for (size_t i = 0, nargs = ft->getNumChildren() - 1; i < nargs; i++)
+    {
+      ExprValue* p = (*ft)[i];
+      p = p->getKind() == Kind::QUOTE_TYPE ? (*p)[0] : p;
+      // argument types that require evaluation depend on the context
+      if (p->isEvaluatable())
+      {
+        pats.clear();
+        break;
+      }
+      pats.push_back(p);
+    }
+    if (pats.size() + 1 == ft->getNumChildren())
+    {
+      ainfo.d_compiledArgTypes.reset(new CompiledPattern(pats, false));
+    }
+  }
+  return ainfo.d_compiledArgTypes.get();
+}
+
 bool State::getOracleCmd(const ExprValue* oracle, std::string& ocmd)
 {
   AppInfo* ainfo = getAppInfo(oracle);
@@ -1272,23 +1415,22 @@ size_t State::getAssumptionLevel() const
   return d_assumptionsSizeCtx.size();
 }
 
-std::vector<Expr> State::getCurrentAssumptions() const
+ArrayView<Expr> State::getCurrentAssumptions() const
 {
   size_t start = d_assumptionsSizeCtx.empty() ? 0 : d_assumptionsSizeCtx.back();
-  std::vector<Expr> as(d_assumptions.begin()+start, d_assumptions.end());
-  return as;
+  return ArrayView<Expr>(d_assumptions.data() + start,
+                         d_assumptions.size() - start);
 }
 
 size_t State::getHash(const ExprValue* e)
 {
-  std::map<const ExprValue*, size_t>::const_iterator it = d_hashMap.find(e);
-  if (it!=d_hashMap.end())
+  Assert(e->d_id < d_hashMap.size());
+  size_t& ret = d_hashMap[e->d_id];
+  if (ret == 0)
   {
-    return it->second;
+    d_hashCounter++;
+    ret = d_hashCounter;
   }
-  d_hashCounter++;
-  size_t ret = d_hashCounter;
-  d_hashMap[e] = ret;
   return ret;
 }
 
@@ -1307,36 +1449,90 @@ bool State::isProofRuleSorry(const ExprValue* e) const
   return d_pfrSorry.find(e)!=d_pfrSorry.end();
 }
 
+void State::markProgramUncached(const ExprValue* e)
+{
+  d_progUncached.insert(e);
+}
+
+bool State::isProgramUncached(const ExprValue* e) const
+{
+  return d_progUncached.find(e) != d_progUncached.end()
+         || d_progOracle.find(e) != d_progOracle.end();
+}
+
 AppInfo* State::getAppInfo(const ExprValue* e)
 {
   Assert (e->getKind()!=Kind::PARAMETERIZED);
-  std::map<const ExprValue *, AppInfo>::iterator it = d_appData.find(e);
-  if (it!=d_appData.end())
-  {
-    return &it->second;
-  }
-  return nullptr;
+  Assert(e->d_id < d_appData.size());
+  return d_appData[e->d_id].get();
 }
 
 const AppInfo* State::getAppInfo(const ExprValue* e) const
 {
   Assert (e->getKind()!=Kind::PARAMETERIZED);
-  std::map<const ExprValue *, AppInfo>::const_iterator it = d_appData.find(e);
-  if (it!=d_appData.end())
+  Assert(e->d_id < d_appData.size());
+  return d_appData[e->d_id].get();
+}
+
+AppInfo& State::getOrMkAppInfo(const ExprValue* e)
+{
+  Assert(e->d_id != 0 && e->d_id < d_appData.size());
+  std::unique_ptr<AppInfo>& ai = d_appData[e->d_id];
+  if (ai == nullptr)
   {
-    return &it->second;
+    ai.reset(new AppInfo);
   }
-  return nullptr;
+  return *ai;
 }
 
-ExprValue* State::lookupType(const ExprValue* e) const
+void State::assignId(ExprValue* e)
+{
+  if (!d_freeIds.empty())
+  {
+    e->d_id = d_freeIds.back();
+    d_freeIds.pop_back();
+    return;
+  }
+  // identifier 0 is reserved for expressions not constructed here
+  size_t id = d_typeCache.size();
+  Assert(id <= UINT32_MAX);
+  e->d_id = static_cast<uint32_t>(id);
+  d_appData.emplace_back();
+  d_hashMap.push_back(0);
+  d_typeCache.emplace_back();
+}
+
+void State::setImmortal(ExprValue* e)
 {
-  std::map<const ExprValue*, Expr>::const_iterator itt = d_typeCache.find(e);
-  if (itt != d_typeCache.end())
+  bool noGc = !d_opts.d_gc && !d_noGcLimitExceeded;
+  // check the memory limit once per slab of the arena
+  if (noGc && d_arena.getNumSlabs() >= d_noGcCheckSlabs)
   {
-    return itt->second.getValue();
+    d_noGcCheckSlabs = d_arena.getNumSlabs() + 1;
+    size_t mb = d_opts.d_noGcLimit;
+    size_t limit = mb > (SIZE_MAX >> 20) ? SIZE_MAX : mb << 20;
+    if (limit > 0 && getPeakResidentMemory() > limit)
+    {
+      // terms made from now on are deleted when no longer referenced, the
+      // ones made so far remain immortal
+      Trace("gc") << "Exceeded memory limit, enable garbage collection"
+                  << std::endl;
+      d_noGcLimitExceeded = true;
+      noGc = false;
+    }
+  }
+  if (d_mkImmortal || noGc)
+  {
+    e->setFlag(ExprValue::Flag::IS_IMMORTAL, true);
+    d_stats.d_immortalCount++;
   }
-  return nullptr;
+}
+
+ExprValue* State::lookupType(const ExprValue* e) const
+{
+  Assert(e->d_id < d_typeCache.size());
+  const Expr& t = d_typeCache[e->d_id];
+  return t.isNull() ? nullptr : t.getValue();
 }
 
 TypeChecker& State::getTypeChecker()
@@ -1381,7 +1577,7 @@ void State::bindBuiltin(const std::string& name, Kind k, Attr ac, const Expr& t)
   if (ac!=Attr::NONE || k!=Kind::NONE)
   {
     // associate the information
-    AppInfo& ai = d_appData[c.getValue()];
+    AppInfo& ai = getOrMkAppInfo(c.getValue());
     ai.d_kind = k;
     ai.d_attrCons = ac;
   }
@@ -1395,12 +1591,72 @@ void State::bindBuiltinEval(const std::string& name, Kind k, Attr ac)
 void State::defineProgram(const Expr& v, const Expr& prog)
 {
   markConstructorKind(v, Attr::PROGRAM, prog);
+  // index the cases of the program
+  getOrMkAppInfo(v.getValue()).d_caseIndex.reset(new CaseIndex(prog));
+  // find the oracles and programs called by the cases of v
+  bool callsOracle = false;
+  std::unordered_set<const ExprValue*> visited;
+  std::vector<const ExprValue*> toVisit{prog.getValue()};
+  const ExprValue* cur;
+  while (!toVisit.empty())
+  {
+    cur = toVisit.back();
+    toVisit.pop_back();
+    if (!visited.insert(cur).second)
+    {
+      continue;
+    }
+    Kind k = cur->getKind();
+    if (k == Kind::ORACLE)
+    {
+      callsOracle = true;
+    }
+    else if (k == Kind::PROGRAM_CONST && cur != v.getValue())
+    {
+      // remember v as a caller, in case cur is later found to call an oracle
+      d_progCallers[cur].push_back(v.getValue());
+      callsOracle = callsOracle || d_progOracle.find(cur) != d_progOracle.end();
+    }
+    ArrayView<ExprValue*> children = cur->getChildren();
+    toVisit.insert(toVisit.end(), children.begin(), children.end());
+  }
+  if (callsOracle)
+  {
+    markProgramOracle(v.getValue());
+  }
+  // applications of v may have been cached as not evaluating, if v was
+  // forward declared, which may also impact the types of applications and
+  // the types used to resolve overloads
+  d_evalCache.clear();
+  d_overloadCache.clear();
+  d_typeAppCache.clear();
   if (d_plugin!=nullptr)
   {
     d_plugin->defineProgram(v, prog);
   }
 }
 
+void State::markProgramOracle(const ExprValue* v)
+{
+  std::vector<const ExprValue*> toMark{v};
+  while (!toMark.empty())
+  {
+    const ExprValue* cur = toMark.back();
+    toMark.pop_back();
+    if (!d_progOracle.insert(cur).second)
+    {
+      continue;
+    }
+    std::unordered_map<const ExprValue*,
+                       std::vector<const ExprValue*>>::iterator it =
+        d_progCallers.find(cur);
+    if (it != d_progCallers.end())
+    {
+      toMark.insert(toMark.end(), it->second.begin(), it->second.end());
+    }
+  }
+}
+
 bool State::markConstructorKind(const Expr& v, Attr a, const Expr& cons)
 {
   Expr acons = cons;
@@ -1422,7 +1678,7 @@ bool State::markConstructorKind(const Expr& v, Attr a, const Expr& cons)
     acons = mkLiteral(Kind::STRING, inputPath.getRawPath());
   }
   Assert (isSymbol(v.getKind()));
-  AppInfo& ai = d_appData[v.getValue()];
+  AppInfo& ai = getOrMkAppInfo(v.getValue());
   Assert (ai.d_attrCons==Attr::NONE);
   ai.d_attrCons = a;
   ai.d_attrConsTerm = acons;
@@ -1433,34 +1689,91 @@ bool State::markConstructorKind(const Expr& v, Attr a, const Expr& cons)
   return true;
 }
 
-Expr State::getOverloadInternal(const std::vector<Expr>& overloads,
-                                const std::vector<Expr>& children,
+Expr State::getOverloadInternal(ArrayView<Expr> overloads,
+                                ArrayView<Expr> children,
+                                bool cacheable,
                                 const ExprValue* retType)
 {
   Assert (!overloads.empty());
   Trace("overload") << "Get overload" << std::endl;
+  std::vector<ExprValue*> key;
+  for (const Expr& o : overloads)
+  {
+    key.push_back(o.getValue());
+  }
+  key.push_back(nullptr);
+  cacheable = cacheable && d_overloadCache.isEnabled();
+  for (size_t i = 1, nchildren = children.size(); cacheable && i < nchildren;
+       i++)
+  {
+    // use the type of the argument if already computed, which is typically
+    // the case, since arguments are type checked when they are constructed
+    ExprValue* ct = lookupType(children[i].getValue());
+    if (ct == nullptr)
+    {
+      Expr cte = d_tc.getType(children[i]);
+      ct = cte.isNull() ? nullptr : cte.getValue();
+      cacheable = ct != nullptr;
+    }
+    key.push_back(ct);
+  }
+  key.push_back(const_cast<ExprValue*>(retType));
+  if (cacheable)
+  {
+    Expr cached;
+    if (d_overloadCache.find(key, cached))
+    {
+      return cached;
+    }
+  }
   std::vector<ExprValue*> vchildren;
+  vchildren.reserve(children.size());
   for (const Expr& c : children)
   {
     vchildren.push_back(c.getValue());
   }
+  Expr ret = d_null;
   // try overloads in order until one is found
   for (size_t i=0, noverloads = overloads.size(); i<noverloads; i++)
   {
     // search in reverse order, i.e. the last bound symbol takes precendence
     size_t ii = (noverloads-1)-i;
     vchildren[0] = overloads[ii].getValue();
+    d_stats.d_overloadCheckCount++;
     Expr x = Expr(vchildren.size()>2 ? mkApplyInternal(vchildren) : mkExprInternal(Kind::APPLY, vchildren));
     Expr t = d_tc.getType(x);
     // if term is well-formed, and matches the return type if it exists
     if (!t.isNull() && (retType==nullptr || retType==t.getValue()))
     {
       // return the operator, do not check the remainder
-      return overloads[ii];
+      ret = overloads[ii];
+      break;
     }
   }
   // otherwise, none found, return null
-  return d_null;
+  if (cacheable)
+  {
+    d_overloadCache.insert(key, ret);
+  }
+  return ret;
+}
+
+bool State::hasQuotedArgument(const Expr& e)
+{
+  Expr t = d_tc.getType(e);
+  while (!t.isNull() && t.getKind() == Kind::FUNCTION_TYPE)
+  {
+    size_t nargs = t.getNumChildren() - 1;
+    for (size_t i = 0; i < nargs; i++)
+    {
+      if (t[i].getKind() == Kind::QUOTE_TYPE)
+      {
+        return true;
+      }
+    }
+    t = t[nargs];
+  }
+  return false;
 }
 
 }  // namespace ethos
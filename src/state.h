@@ -9,6 +9,7 @@
 #ifndef STATE_H
 #define STATE_H
 
+#include <initializer_list>
 #include <map>
 #include <set>
 #include <string>
@@ -18,10 +19,16 @@
 #include "plugin.h"
 #include "expr.h"
 #include "expr_info.h"
-#include "expr_trie.h"
+#include "eval_cache.h"
+#include "expr_arena.h"
+#include "expr_hash.h"
+#include "expr_table.h"
+#include "list_cache.h"
 #include "literal.h"
 #include "stats.h"
+#include "symbol_table.h"
 #include "type_checker.h"
+#include "util/array_view.h"
 #include "util/filesystem.h"
 
 namespace ethos {
@@ -34,6 +41,12 @@ class Options
    * @return true if the option was successfully set.
    */
   bool setOption(const std::string& key, bool val);
+  /**
+   * @return true if the numeric option was successfully set.
+   */
+  bool setNumericOption(const std::string& key, size_t val);
+  /** @return true if key is the name of a numeric option. */
+  static bool isNumericOption(const std::string& key);
   bool d_printLet;
   /** 'let' is lexed as the SMT-LIB syntax for a dag term specified by a let */
   bool d_parseLet;
@@ -46,6 +59,17 @@ class Options
   bool d_normalizeNumeral;
   /** Binders generate fresh variables in proof and reference files */
   bool d_binderFresh;
+  /** Match program cases and function types using compiled patterns */
+  bool d_bytecodeMatch;
+  /** The memory limit for the program evaluation cache, in megabytes */
+  size_t d_evalCacheLimit;
+  /** Whether terms that are no longer referenced are deleted */
+  bool d_gc;
+  /**
+   * The memory limit in megabytes above which terms are again deleted when
+   * d_gc is false, or 0 if there is no limit.
+   */
+  size_t d_noGcLimit;
 };
 
 /**
@@ -92,6 +116,12 @@ class State
   bool markConstructorKind(const Expr& v, Attr a, const Expr& cons);
   /** Define program, where v is PROGRAM_CONST and prog is PROGRAM. */
   void defineProgram(const Expr& v, const Expr& prog);
+  /**
+   * Mark v as a program that may call an oracle, as well as the programs
+   * that call it. The results of these programs are not cached, since
+   * oracles may not be deterministic.
+   */
+  void markProgramOracle(const ExprValue* v);
   //--------------------------------------
   /** Type */
   Expr mkType();
@@ -121,8 +151,9 @@ class State
   Expr mkConclusion();
   /** Make pair */
   Expr mkPair(const Expr& t1, const Expr& t2);
-  /** */
-  Expr mkExpr(Kind k, const std::vector<Expr>& children);
+  /** Make the term of kind k with the given children */
+  Expr mkExpr(Kind k, ArrayView<Expr> children);
+  Expr mkExpr(Kind k, std::initializer_list<Expr> children);
   /** make true */
   Expr mkTrue();
   /** make false */
@@ -154,18 +185,37 @@ class State
   Expr getBoundVar(const std::string& name, const Expr& type);
   /** Get the proof rule with the given name or nullptr if it does not exist */
   Expr getProofRule(const std::string& name) const;
-  /** Get actual premises */
+  /**
+   * Get actual premises, where the terms in given are moved to actual if the
+   * rule does not have a premise list.
+   */
   bool getActualPremises(const ExprValue* ev,
                          std::vector<Expr>& given,
                          std::vector<Expr>& actual);
   /** Get the program */
   Expr getProgram(const ExprValue* ev);
+  /** Get the index over the cases of program ev, if it is defined */
+  const CaseIndex* getCaseIndex(const ExprValue* ev);
+  /**
+   * Get the compiled patterns for the arguments of the cases of program ev,
+   * which is defined.
+   */
+  const std::vector<std::unique_ptr<CompiledPattern>>& getCompiledProgram(
+      const ExprValue* ev);
+  /**
+   * Get the compiled pattern for the argument types of function type ft, or
+   * null if they cannot be compiled.
+   */
+  const CompiledPattern* getCompiledFunctionType(const ExprValue* ft);
   /** Get the oracle command */
   bool getOracleCmd(const ExprValue* ev, std::string& ocmd);
   /** */
   size_t getAssumptionLevel() const;
-  /** */
-  std::vector<Expr> getCurrentAssumptions() const;
+  /**
+   * Get the assumptions at the current assumption level, which is valid until
+   * the next assumption is pushed or popped.
+   */
+  ArrayView<Expr> getCurrentAssumptions() const;
   /** Get hash for expression */
   size_t getHash(const ExprValue* ev);
   /**
@@ -182,6 +232,13 @@ class State
   void markProofRuleSorry(const ExprValue * e);
   /** Does e refer to a proof rule marked :sorry? */
   bool isProofRuleSorry(const ExprValue* e) const;
+  /** Mark e as a program whose results should not be cached */
+  void markProgramUncached(const ExprValue* e);
+  /**
+   * Does e refer to a program whose results should not be cached, i.e. it is
+   * marked :uncached or it may call an oracle?
+   */
+  bool isProgramUncached(const ExprValue* e) const;
   //--------------------------------------
   /** Get the type checker */
   TypeChecker& getTypeChecker();
@@ -195,6 +252,11 @@ class State
   Plugin* getPlugin();
 
  private:
+  /**
+   * The allocator for all expressions we construct. This is declared first so
+   * that it is destroyed last.
+   */
+  ExprArena d_arena;
   /** Common constants */
   Expr d_null;
   Expr d_type;
@@ -211,6 +273,26 @@ class State
   bool markIncluded(const Filepath& s);
   /** mark deleted */
   void markDeleted(ExprValue* e);
+  /** Allocate a new literal in d_arena, constructed from args */
+  template <typename... Args>
+  Literal* newLiteral(Args&&... args)
+  {
+    void* mem = d_arena.allocate(sizeof(Literal));
+    Literal* l = new (mem) Literal(std::forward<Args>(args)...);
+    assignId(l);
+    setImmortal(l);
+    return l;
+  }
+  /**
+   * Set whether the new term e is immortal, i.e. if it is made while including
+   * a signature, or if garbage collection is disabled and the memory limit is
+   * not exceeded.
+   */
+  void setImmortal(ExprValue* e);
+  /** Assign a fresh identifier to e, growing the side tables if needed */
+  void assignId(ExprValue* e);
+  /** Get the constructor info for e, constructing it if it does not exist */
+  AppInfo& getOrMkAppInfo(const ExprValue* e);
   /** Make (<APPLY> children), curried. */
   ExprValue* mkApplyInternal(const std::vector<ExprValue*>& children);
   /**
@@ -231,15 +313,24 @@ class State
    * @param overloads The candidate operators.
    * @param children The children of the Kind::APPLY we are trying to
    * construct. This includes a head operator.
+   * @param cacheable Whether the result may be cached, i.e. none of the
+   * overloads has a quoted argument, see hasQuotedArgument. Otherwise the
+   * result may depend on the children themselves, not only on their types.
    * @param retType If non-null, this is required return type of the
    * application.
    * @return If possible, one of the elements of overloads that meets
    * the above requirements. If multiple are possible, we return the
    * first only. If none are possible, we return the null expression.
    */
-  Expr getOverloadInternal(const std::vector<Expr>& overloads,
-                           const std::vector<Expr>& children,
+  Expr getOverloadInternal(ArrayView<Expr> overloads,
+                           ArrayView<Expr> children,
+                           bool cacheable,
                            const ExprValue* retType = nullptr);
+  /**
+   * Does the type of e have a quoted argument, including in the function
+   * types it returns?
+   */
+  bool hasQuotedArgument(const Expr& e);
   /** Get the internal data for expression e. */
   AppInfo* getAppInfo(const ExprValue* e);
   const AppInfo* getAppInfo(const ExprValue* e) const;
@@ -251,43 +342,57 @@ class State
   void bindBuiltinEval(const std::string& name, Kind k, Attr ac = Attr::NONE);
   //--------------------- parsing state
   /** The symbol table, mapping symbols */
-  std::map<std::string, Expr> d_symTable;
+  SymbolTable d_symTable;
   /** Symbol table for proof rules, if using separate table */
-  std::map<std::string, Expr> d_ruleSymTable;
-  /** The (canonical) bound variables for binders */
-  std::map<std::pair<std::string, const ExprValue*>, Expr> d_boundVars;
+  SymbolTable d_ruleSymTable;
+  /** Hash function for the keys of d_boundVars */
+  struct BoundVarHashFunction
+  {
+    size_t operator()(const std::pair<StringId, const ExprValue*>& k) const
+    {
+      return std::hash<const ExprValue*>()(k.second) * 31 + k.first;
+    }
+  };
   /**
-   * The list of declared symbols in the order they were bound.
+   * The (canonical) bound variables for binders, by the handle of their name
+   * in the string pool and their type.
    */
-  std::vector<std::string> d_decls;
+  std::unordered_map<std::pair<StringId, const ExprValue*>,
+                     Expr,
+                     BoundVarHashFunction>
+      d_boundVars;
   /**
-   * The list of declared symbols that were overloaded when they
-   * were bound. This is a sublist of d_decls. For example if
-   *   d_decls = { "A", "B", "A", "C", "A", "B" }
-   * then
-   *   d_overloadedDecls = { "A", "A", "B" }.
+   * The symbols that were overloaded when they were bound at non-global
+   * scope, i.e. whose overloads were extended, in the order they were bound.
    */
-  std::vector<std::string> d_overloadedDecls;
+  std::vector<Expr> d_overloadedDecls;
   /**
-   * Context size, which is the size of d_decls at the time of when each
-   * current pushScope was called.
+   * Context size, which is the size of d_overloadedDecls at the time of when
+   * each current pushScope was called.
    */
-  std::vector<size_t> d_declsSizeCtx;
+  std::vector<size_t> d_overloadedDeclsSizeCtx;
   /** All free assumptions */
   std::vector<Expr> d_assumptions;
   /** Context size */
   std::vector<size_t> d_assumptionsSizeCtx;
   //--------------------- expression info
+  /**
+   * The side tables below are indexed by the identifier of expressions
+   * (ExprValue::d_id). Identifiers are dense, and are recycled when an
+   * expression is deleted, at which point its entries are cleared.
+   */
   /** Map from expressions to constructor info */
-  std::map<const ExprValue*, AppInfo> d_appData;
-  /** Map from expressions to hash */
-  std::map<const ExprValue*, size_t> d_hashMap;
+  std::vector<std::unique_ptr<AppInfo>> d_appData;
+  /** Map from expressions to hash, or 0 if not yet computed */
+  std::vector<size_t> d_hashMap;
   /** Mapping expressions to types */
-  std::map<const ExprValue*, Expr> d_typeCache;
+  std::vector<Expr> d_typeCache;
+  /** Identifiers of deleted expressions, available for reuse */
+  std::vector<uint32_t> d_freeIds;
   /** Hash counter */
   size_t d_hashCounter;
   /** The database of created expressions */
-  std::map<Kind, ExprTrie> d_trie;
+  ExprTable d_table;
   //--------------------- literals
   /** Cache for literals */
   std::unordered_map<Rational, Expr, RationalHashFunction> d_litRatMap[2];
@@ -302,6 +407,13 @@ class State
   Filepath d_inputFile;
   /** The proof rules marked :sorry */
   std::unordered_set<const ExprValue*> d_pfrSorry;
+  /** The programs marked :uncached */
+  std::unordered_set<const ExprValue*> d_progUncached;
+  /** The programs that may call an oracle, directly or via other programs */
+  std::unordered_set<const ExprValue*> d_progOracle;
+  /** Maps programs to the defined programs whose cases call them */
+  std::unordered_map<const ExprValue*, std::vector<const ExprValue*>>
+      d_progCallers;
   /** Cache of files included */
   std::set<Filepath> d_includes;
   /** Have we parsed a reference file to check assumptions? */
@@ -317,9 +429,43 @@ class State
   std::vector<ExprValue*> d_toDelete;
   /** Are we in garbage collection? */
   bool d_inGarbageCollection;
+  /**
+   * Are the terms we make immortal? This is the case for the builtin terms
+   * and the terms made while including signatures from another file, which
+   * are typically referenced throughout the remainder of the run.
+   */
+  bool d_mkImmortal;
+  /**
+   * Has the memory limit d_opts.d_noGcLimit been exceeded? If garbage
+   * collection is disabled, all terms we make are immortal until this is the
+   * case. Terms made afterwards are deleted when no longer referenced, the
+   * ones made before remain immortal, since their reference counts were not
+   * maintained. Hence the limit stops the growth due to new terms, but does
+   * not free the memory used so far.
+   */
+  bool d_noGcLimitExceeded;
+  /** The number of arena slabs at which we next check the memory limit */
+  size_t d_noGcCheckSlabs;
   //--------------------- utilities
   /** Type checker */
   TypeChecker d_tc;
+  /** Cache of the results of programs, persistent across evaluations */
+  EvalCache d_evalCache;
+  /** Cache of the flattened form of lists, used by list operators */
+  ListCache d_listCache;
+  /**
+   * Cache for getOverloadInternal. This maps the candidate overloads, a null
+   * separator, the types of the arguments and the required return type (or
+   * null) to the chosen overload, or null if none applies.
+   */
+  EvalCache d_overloadCache;
+  /**
+   * Cache of the types of applications, used by the type checker. This maps
+   * the type of the head of an application followed by the types of its
+   * arguments to the type of the application, or null if it is not
+   * well-typed. It is not used for applications with quoted arguments.
+   */
+  EvalCache d_typeAppCache;
   /** Options */
   Options& d_opts;
   /** Stats */
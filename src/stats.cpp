@@ -16,13 +16,15 @@
 #include "base/check.h"
 #include "expr.h"
 #include "state.h"
+#include "string_pool.h"
 
 namespace ethos {
 
 std::time_t RuleStat::d_startTime;
 size_t RuleStat::d_startMkExprCount;
+size_t RuleStat::d_startTempCount;
   
-RuleStat::RuleStat() : d_count(0), d_mkExprCount(0), d_time(0)
+RuleStat::RuleStat() : d_count(0), d_mkExprCount(0), d_tempCount(0), d_time(0)
 {
 }
 
@@ -30,12 +32,14 @@ void RuleStat::start(Stats& s)
 {
   d_startTime = Stats::getCurrentTime();
   d_startMkExprCount = s.d_mkExprCount;
+  d_startTempCount = s.d_tempCount;
 }
 
 void RuleStat::increment(Stats& s)
 {
   // we assume count is already incremented separately
   d_mkExprCount += (s.d_mkExprCount-d_startMkExprCount);
+  d_tempCount += (s.d_tempCount-d_startTempCount);
   d_time += (Stats::getCurrentTime()-d_startTime);
 }
   
@@ -57,10 +61,34 @@ std::string RuleStat::toString(std::time_t totalTime) const
   std::stringstream se;
   se << d_mkExprCount;
   ss << std::left << std::setw(10) << se.str();
+  std::stringstream stc;
+  stc << d_tempCount;
+  ss << std::left << std::setw(10) << stc.str();
   return ss.str();
 }
   
-Stats::Stats() : d_mkExprCount(0), d_exprCount(0), d_deleteExprCount(0), d_symCount(0), d_litCount(0)
+Stats::Stats()
+    : d_mkExprCount(0),
+      d_exprCount(0),
+      d_deleteExprCount(0),
+      d_symCount(0),
+      d_litCount(0),
+      d_exprProbeCount(0),
+      d_exprProbeMax(0),
+      d_evalCacheHit(0),
+      d_evalCacheMiss(0),
+      d_evalCacheEvict(0),
+      d_progEvalCount(0),
+      d_progCaseCount(0),
+      d_overloadCheckCount(0),
+      d_overloadCacheHit(0),
+      d_overloadCacheMiss(0),
+      d_overloadCacheEvict(0),
+      d_typeAppCacheHit(0),
+      d_typeAppCacheMiss(0),
+      d_typeAppCacheEvict(0),
+      d_immortalCount(0),
+      d_tempCount(0)
 {
   d_startTime = getCurrentTime();
 }
@@ -95,6 +123,25 @@ std::string Stats::toString(State& s, bool compact) const
   ss << "deleteExprCount = " << d_deleteExprCount << std::endl;
   ss << "symCount = " << d_symCount << std::endl;
   ss << "litCount = " << d_litCount << std::endl;
+  ss << "exprProbeCount = " << d_exprProbeCount << std::endl;
+  ss << "exprProbeMax = " << d_exprProbeMax << std::endl;
+  ss << "evalCacheHit = " << d_evalCacheHit << std::endl;
+  ss << "evalCacheMiss = " << d_evalCacheMiss << std::endl;
+  ss << "evalCacheEvict = " << d_evalCacheEvict << std::endl;
+  ss << "progEvalCount = " << d_progEvalCount << std::endl;
+  ss << "progCaseCount = " << d_progCaseCount << std::endl;
+  ss << "overloadCheckCount = " << d_overloadCheckCount << std::endl;
+  ss << "overloadCacheHit = " << d_overloadCacheHit << std::endl;
+  ss << "overloadCacheMiss = " << d_overloadCacheMiss << std::endl;
+  ss << "overloadCacheEvict = " << d_overloadCacheEvict << std::endl;
+  ss << "typeAppCacheHit = " << d_typeAppCacheHit << std::endl;
+  ss << "typeAppCacheMiss = " << d_typeAppCacheMiss << std::endl;
+  ss << "typeAppCacheEvict = " << d_typeAppCacheEvict << std::endl;
+  ss << "tempCount = " << d_tempCount << std::endl;
+  ss << "immortalCount = " << d_immortalCount << std::endl;
+  const StringPool& sp = StringPool::get();
+  ss << "symPoolCount = " << sp.size() << std::endl;
+  ss << "symPoolBytes = " << sp.getNumBytes() << std::endl;
   std::time_t totalTime = (getCurrentTime()-d_startTime);
   ss << "time = " << totalTime << std::endl;
   if (!d_rstats.empty())
@@ -107,6 +154,7 @@ std::string Stats::toString(State& s, bool compact) const
       ss << std::left << std::setw(7) << "#";
       ss << std::left << std::setw(10) << "t/#";
       ss << std::left << std::setw(10) << "#mkExpr";
+      ss << std::left << std::setw(10) << "#temp";
       ss << std::endl;
       ss << "========================================================================" << std::endl;
     }
@@ -122,6 +170,7 @@ std::string Stats::toString(State& s, bool compact) const
     std::map<const ExprValue*, RuleStat>::const_iterator itr;
     std::stringstream ssCheck;
     std::stringstream ssMkExpr;
+    std::stringstream ssTemp;
     bool firstTime = true;
     for (const ExprValue* e : sortedStats)
     {
@@ -141,9 +190,11 @@ std::string Stats::toString(State& s, bool compact) const
         {
           ssCheck << ", ";
           ssMkExpr << ", ";
+          ssTemp << ", ";
         }
         ssCheck << sss.str() << ": " << rs.d_time;
         ssMkExpr << sss.str() << ": " << rs.d_mkExprCount;
+        ssTemp << sss.str() << ": " << rs.d_tempCount;
       }
       else
       {
@@ -155,6 +206,7 @@ std::string Stats::toString(State& s, bool compact) const
     {
       ss << "checkTime = { " << ssCheck.str() << " }" << std::endl;
       ss << "mkExpr = { " << ssMkExpr.str() << " }" << std::endl;
+      ss << "temp = { " << ssTemp.str() << " }" << std::endl;
     }
   }
   return ss.str();
@@ -26,11 +26,14 @@ class RuleStat
   RuleStat();
   size_t d_count;
   size_t d_mkExprCount;
+  /** Number of temporary terms of evaluation that were not interned */
+  size_t d_tempCount;
   std::time_t d_time;
   void increment(Stats& s);
   // frame
   static std::time_t d_startTime;
   static size_t d_startMkExprCount;
+  static size_t d_startTempCount;
   static void start(Stats& s);
   std::string toString(std::time_t totalTime) const;
 };
@@ -44,6 +47,41 @@ public:
   size_t d_deleteExprCount;
   size_t d_symCount;
   size_t d_litCount;
+  /** Number of slots inspected when looking up terms in the expression table */
+  size_t d_exprProbeCount;
+  /** The maximum number of slots inspected for a single lookup */
+  size_t d_exprProbeMax;
+  /** Number of program applications found in the evaluation cache */
+  size_t d_evalCacheHit;
+  /** Number of program applications not found in the evaluation cache */
+  size_t d_evalCacheMiss;
+  /** Number of entries evicted from the evaluation cache */
+  size_t d_evalCacheEvict;
+  /** Number of program applications interpreted */
+  size_t d_progEvalCount;
+  /** Number of cases of programs tried when interpreting them */
+  size_t d_progCaseCount;
+  /** Number of candidate overloads type checked when resolving overloads */
+  size_t d_overloadCheckCount;
+  /** Number of overload resolutions found in the overload cache */
+  size_t d_overloadCacheHit;
+  /** Number of overload resolutions not found in the overload cache */
+  size_t d_overloadCacheMiss;
+  /** Number of entries evicted from the overload cache */
+  size_t d_overloadCacheEvict;
+  /** Number of types of applications found in the cache of application types */
+  size_t d_typeAppCacheHit;
+  /** Number of types of applications not found in that cache */
+  size_t d_typeAppCacheMiss;
+  /** Number of entries evicted from that cache */
+  size_t d_typeAppCacheEvict;
+  /** Number of terms made immortal, which are not reference counted */
+  size_t d_immortalCount;
+  /**
+   * Number of temporary terms made during evaluation that were not interned,
+   * i.e. intermediate values of literal operators.
+   */
+  size_t d_tempCount;
   std::time_t d_startTime;
   std::map<const ExprValue*, RuleStat> d_rstats;
   std::string toString(State& s, bool compact) const;
@@ -0,0 +1,78 @@
+/******************************************************************************
+ * This file is part of the ethos project.
+ *
+ * Copyright (c) 2023-2024 by the authors listed in the file AUTHORS
+ * in the top-level source directory and their institutional affiliations.
+ * All rights reserved.  See the file COPYING in the top-level source
+ * directory for licensing information.
+ ******************************************************************************/
+#include "string_pool.h"
+
+#include "base/check.h"
+
+namespace ethos {
+
+StringPool::StringPool() : d_numBytes(0) {}
+
+StringPool& StringPool::get()
+{
+  static StringPool pool;
+  return pool;
+}
+
+StringId StringPool::intern(std::string_view s)
+{
+  std::unordered_map<std::string_view, StringId>::iterator it = d_ids.find(s);
+  if (it != d_ids.end())
+  {
+    d_refs[it->second]++;
+    return it->second;
+  }
+  StringId id;
+  if (!d_free.empty())
+  {
+    id = d_free.back();
+    d_free.pop_back();
+    d_strings[id] = s;
+  }
+  else
+  {
+    id = static_cast<StringId>(d_strings.size());
+    d_strings.emplace_back(s);
+    d_refs.push_back(0);
+  }
+  d_refs[id] = 1;
+  d_numBytes += s.size();
+  // the key views the stored copy
+  d_ids.emplace(d_strings[id], id);
+  return id;
+}
+
+void StringPool::release(StringId id)
+{
+  Assert(d_refs[id] > 0);
+  if (--d_refs[id] > 0)
+  {
+    return;
+  }
+  std::string& s = d_strings[id];
+  d_ids.erase(s);
+  d_numBytes -= s.size();
+  // free the characters, the slot is reused by the next string interned
+  std::string().swap(s);
+  d_free.push_back(id);
+}
+
+bool StringPool::find(std::string_view s, StringId& id) const
+{
+  std::unordered_map<std::string_view, StringId>::const_iterator it =
+      d_ids.find(s);
+  if (it == d_ids.end())
+  {
+    return false;
+  }
+  id = it->second;
+  return true;
+}
+
+}  // namespace ethos
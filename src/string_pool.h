@@ -0,0 +1,77 @@
+/******************************************************************************
+ * This file is part of the ethos project.
+ *
+ * Copyright (c) 2023-2024 by the authors listed in the file AUTHORS
+ * in the top-level source directory and their institutional affiliations.
+ * All rights reserved.  See the file COPYING in the top-level source
+ * directory for licensing information.
+ ******************************************************************************/
+#ifndef STRING_POOL_H
+#define STRING_POOL_H
+
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace ethos {
+
+/** A handle to a string in the string pool */
+using StringId = uint32_t;
+
+/**
+ * The process-wide pool of interned strings, used for the names of symbols.
+ *
+ * Each distinct string is stored once and identified by a 32-bit handle,
+ * which is what symbols, symbol tables and their undo logs store. Strings
+ * are reference counted by the symbols and symbol tables that hold their
+ * handle. A string is removed from the pool once it is no longer referenced,
+ * and its handle is reused for strings interned later.
+ */
+class StringPool
+{
+ public:
+  /** Get the pool */
+  static StringPool& get();
+  /**
+   * Get the handle for s, adding it to the pool if it is not there. The
+   * caller holds a reference to the handle, which must be released by
+   * release.
+   */
+  StringId intern(std::string_view s);
+  /** Add a reference to the handle id */
+  void addRef(StringId id) { d_refs[id]++; }
+  /** Release a reference to id, removing its string if it was the last */
+  void release(StringId id);
+  /**
+   * Find the handle for s, without adding it or a reference to it.
+   *
+   * @return true if s is in the pool, in which case id is set to its handle.
+   */
+  bool find(std::string_view s, StringId& id) const;
+  /** Get the string with the given handle */
+  const std::string& getString(StringId id) const { return d_strings[id]; }
+  /** The number of strings in the pool */
+  size_t size() const { return d_strings.size() - d_free.size(); }
+  /** The number of bytes of the characters of the strings in the pool */
+  size_t getNumBytes() const { return d_numBytes; }
+
+ private:
+  StringPool();
+  /** The strings, indexed by their handle, whose addresses do not change */
+  std::deque<std::string> d_strings;
+  /** The number of references to each handle */
+  std::vector<uint32_t> d_refs;
+  /** The handles that are not in use */
+  std::vector<StringId> d_free;
+  /** Map from the strings (viewing d_strings) to their handle */
+  std::unordered_map<std::string_view, StringId> d_ids;
+  /** The number of bytes of the strings */
+  size_t d_numBytes;
+};
+
+}  // namespace ethos
+
+#endif /* STRING_POOL_H */
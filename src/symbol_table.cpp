@@ -0,0 +1,183 @@
+/******************************************************************************
+ * This file is part of the ethos project.
+ *
+ * Copyright (c) 2023-2024 by the authors listed in the file AUTHORS
+ * in the top-level source directory and their institutional affiliations.
+ * All rights reserved.  See the file COPYING in the top-level source
+ * directory for licensing information.
+ ******************************************************************************/
+#include "symbol_table.h"
+
+#include "base/check.h"
+
+namespace ethos {
+
+SymbolTable::SymbolTable() : d_keys(16, s_empty), d_values(16), d_size(0) {}
+
+SymbolTable::~SymbolTable() { releaseKeys(); }
+
+const Expr& SymbolTable::lookup(const std::string& name) const
+{
+  StringId id;
+  // if the name is not in the pool, it is not bound
+  if (!StringPool::get().find(name, id))
+  {
+    return d_null;
+  }
+  return lookup(id);
+}
+
+const Expr& SymbolTable::lookup(StringId id) const
+{
+  size_t i = findSlot(id);
+  if (d_keys[i] == s_empty)
+  {
+    return d_null;
+  }
+  return d_values[i];
+}
+
+void SymbolTable::bind(const std::string& name, const Expr& e)
+{
+  Assert(!e.isNull());
+  StringPool& sp = StringPool::get();
+  StringId id = sp.intern(name);
+  size_t i = findOrAddSlot(id);
+  // the slot holds its own reference to the name
+  sp.release(id);
+  // only have to remember if not at global scope
+  if (!d_undoSizeCtx.empty())
+  {
+    d_undo.emplace_back(id, d_values[i]);
+  }
+  d_values[i] = e;
+}
+
+void SymbolTable::pushScope() { d_undoSizeCtx.push_back(d_undo.size()); }
+
+void SymbolTable::popScope()
+{
+  Assert(!d_undoSizeCtx.empty());
+  size_t lastSize = d_undoSizeCtx.back();
+  d_undoSizeCtx.pop_back();
+  while (d_undo.size() > lastSize)
+  {
+    std::pair<StringId, Expr>& u = d_undo.back();
+    size_t i = findSlot(u.first);
+    Assert(d_keys[i] == u.first);
+    if (u.second.isNull())
+    {
+      // The name was not bound before this scope. Since we never bind null,
+      // there are no earlier entries for it in the undo log.
+      eraseSlot(i);
+    }
+    else
+    {
+      d_values[i] = u.second;
+    }
+    d_undo.pop_back();
+  }
+}
+
+void SymbolTable::clear()
+{
+  releaseKeys();
+  d_keys.assign(16, s_empty);
+  d_values.clear();
+  d_values.resize(16);
+  d_size = 0;
+  d_undo.clear();
+  d_undoSizeCtx.clear();
+}
+
+void SymbolTable::releaseKeys()
+{
+  StringPool& sp = StringPool::get();
+  for (StringId id : d_keys)
+  {
+    if (id != s_empty)
+    {
+      sp.release(id);
+    }
+  }
+}
+
+size_t SymbolTable::findSlot(StringId id) const
+{
+  size_t mask = d_keys.size() - 1;
+  // Handles are assigned consecutively, so names interned together, e.g. the
+  // symbols of a signature, are placed in nearby slots.
+  size_t i = id & mask;
+  // linear probing, the table is never full
+  while (d_keys[i] != id && d_keys[i] != s_empty)
+  {
+    i = (i + 1) & mask;
+  }
+  return i;
+}
+
+size_t SymbolTable::findOrAddSlot(StringId id)
+{
+  Assert(id != s_empty);
+  size_t i = findSlot(id);
+  if (d_keys[i] == s_empty)
+  {
+    // keep the load factor at most 1/2
+    if (2 * (d_size + 1) > d_keys.size())
+    {
+      rehash(2 * d_keys.size());
+      i = findSlot(id);
+    }
+    d_keys[i] = id;
+    d_size++;
+    StringPool::get().addRef(id);
+  }
+  return i;
+}
+
+void SymbolTable::eraseSlot(size_t i)
+{
+  StringPool::get().release(d_keys[i]);
+  size_t mask = d_keys.size() - 1;
+  size_t j = i;
+  // shift back the names after i whose probe sequence passes through i
+  while (true)
+  {
+    j = (j + 1) & mask;
+    if (d_keys[j] == s_empty)
+    {
+      break;
+    }
+    size_t h = d_keys[j] & mask;
+    // skip if the first slot of the name is cyclically in (i, j]
+    if (i <= j ? (i < h && h <= j) : (i < h || h <= j))
+    {
+      continue;
+    }
+    d_keys[i] = d_keys[j];
+    d_values[i] = std::move(d_values[j]);
+    i = j;
+  }
+  d_keys[i] = s_empty;
+  d_values[i] = d_null;
+  d_size--;
+}
+
+void SymbolTable::rehash(size_t capacity)
+{
+  std::vector<StringId> keys(capacity, s_empty);
+  std::vector<Expr> values(capacity);
+  d_keys.swap(keys);
+  d_values.swap(values);
+  for (size_t j = 0, nslots = keys.size(); j < nslots; j++)
+  {
+    if (keys[j] != s_empty)
+    {
+      size_t i = findSlot(keys[j]);
+      d_keys[i] = keys[j];
+      d_values[i] = std::move(values[j]);
+    }
+  }
+}
+
+}  // namespace ethos
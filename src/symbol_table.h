@@ -0,0 +1,81 @@
+/******************************************************************************
+ * This file is part of the ethos project.
+ *
+ * Copyright (c) 2023-2024 by the authors listed in the file AUTHORS
+ * in the top-level source directory and their institutional affiliations.
+ * All rights reserved.  See the file COPYING in the top-level source
+ * directory for licensing information.
+ ******************************************************************************/
+#ifndef SYMBOL_TABLE_H
+#define SYMBOL_TABLE_H
+
+#include <string>
+#include <vector>
+
+#include "expr.h"
+#include "string_pool.h"
+
+namespace ethos {
+
+/**
+ * A scoped symbol table, mapping names to terms.
+ *
+ * Names are interned in the string pool, and the current binding of each name
+ * is stored in an open-addressing hash table keyed by its handle, so that the
+ * size of each table is proportional to the names bound in it. Each slot holds
+ * a reference to its name, and is removed when the scope that first bound the
+ * name is popped. Bindings made
+ * at non-global scope are recorded in an undo log of the handle and its
+ * previous value, which popScope replays in reverse to restore the bindings of
+ * the previous scope.
+ */
+class SymbolTable
+{
+ public:
+  SymbolTable();
+  ~SymbolTable();
+  /** Get the term bound to name, or the null term if it is not bound */
+  const Expr& lookup(const std::string& name) const;
+  /** Get the term bound to the name with handle id */
+  const Expr& lookup(StringId id) const;
+  /** Bind name to e, replacing its current binding in the current scope */
+  void bind(const std::string& name, const Expr& e);
+  /** Push a scope */
+  void pushScope();
+  /** Pop a scope, restoring the bindings from before it was pushed */
+  void popScope();
+  /** The number of scopes pushed, where 0 is the global scope */
+  size_t getLevel() const { return d_undoSizeCtx.size(); }
+  /** Remove all bindings and scopes */
+  void clear();
+
+ private:
+  /** Get the slot of id, which is empty if id has no slot */
+  size_t findSlot(StringId id) const;
+  /** Get the slot of id, adding it if it has none */
+  size_t findOrAddSlot(StringId id);
+  /** Remove the name in slot i, releasing the reference to it */
+  void eraseSlot(size_t i);
+  /** Release the references to the names in d_keys */
+  void releaseKeys();
+  /** Resize the table to the given capacity, a power of two */
+  void rehash(size_t capacity);
+  /** Marks empty slots in d_keys */
+  static constexpr StringId s_empty = UINT32_MAX;
+  /** The handle of the name in each slot, or s_empty */
+  std::vector<StringId> d_keys;
+  /** The current binding of the name in each slot, null if unbound */
+  std::vector<Expr> d_values;
+  /** The number of slots that are not empty */
+  size_t d_size;
+  /** The undo log, the names bound at non-global scope and their old value */
+  std::vector<std::pair<StringId, Expr>> d_undo;
+  /** The size of d_undo at the time each current scope was pushed */
+  std::vector<size_t> d_undoSizeCtx;
+  /** The null term */
+  Expr d_null;
+};
+
+}  // namespace ethos
+
+#endif /* SYMBOL_TABLE_H */
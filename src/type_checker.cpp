@@ -11,6 +11,7 @@
 #include <iostream>
 #include <set>
 #include <unordered_map>
+#include <unordered_set>
 
 #include "base/check.h"
 #include "base/output.h"
@@ -24,7 +25,8 @@
 
 namespace ethos {
 
-TypeChecker::TypeChecker(State& s, Options& opts) : d_state(s), d_plugin(nullptr)
+TypeChecker::TypeChecker(State& s, Options& opts)
+    : d_state(s), d_opts(opts), d_plugin(nullptr), d_numTemps(0)
 {
   std::set<Kind> literalKinds = { Kind::BOOLEAN, Kind::NUMERAL, Kind::RATIONAL, Kind::BINARY, Kind::STRING, Kind::DECIMAL, Kind::HEXADECIMAL };
   // initialize literal kinds 
@@ -76,22 +78,22 @@ ExprValue* TypeChecker::getOrSetLiteralTypeRule(Kind k)
   return it->second.getValue();
 }
 
-Expr TypeChecker::getType(Expr& e, std::ostream* out)
+Expr TypeChecker::getType(const Expr& e, std::ostream* out)
 {
-  std::map<const ExprValue*, Expr>::iterator itt;
   std::unordered_set<ExprValue*> visited;
   std::vector<ExprValue*> toVisit;
   toVisit.push_back(e.getValue());
   ExprValue* cur;
   Expr ret;
-  std::map<const ExprValue*, Expr>& tc = d_state.d_typeCache;
+  std::vector<Expr>& tc = d_state.d_typeCache;
+  std::vector<ExprValue*> spine;
   do
   {
     cur = toVisit.back();
-    itt = tc.find(cur);
-    if (itt != tc.end())
+    Assert(cur->d_id != 0 && cur->d_id < tc.size());
+    if (!tc[cur->d_id].isNull())
     {
-      ret = itt->second;
+      ret = tc[cur->d_id];
       // already computed type
       toVisit.pop_back();
       continue;
@@ -99,7 +101,18 @@ Expr TypeChecker::getType(Expr& e, std::ostream* out)
     if (visited.find(cur)==visited.end())
     {
       visited.insert(cur);
-      toVisit.insert(toVisit.end(), cur->d_children.begin(), cur->d_children.end());
+      // for curried applications, only the arguments along the spine and its
+      // head are type checked, not the partial applications
+      spine.clear();
+      ExprValue* hd = getUncheckedSpine(cur, spine);
+      if (hd != nullptr)
+      {
+        toVisit.push_back(hd);
+        toVisit.insert(toVisit.end(), spine.begin(), spine.end());
+        continue;
+      }
+      ArrayView<ExprValue*> cs = cur->getChildren();
+      toVisit.insert(toVisit.end(), cs.begin(), cs.end());
     }
     else
     {
@@ -122,7 +135,7 @@ Expr TypeChecker::getType(Expr& e, std::ostream* out)
         }
         return d_null;
       }
-      tc[cur] = ret;
+      tc[cur->d_id] = ret;
       Trace("type_checker")
           << "TYPE " << Expr(cur) << " : " << ret << std::endl;
       // std::cout << "...return" << std::endl;
@@ -219,20 +232,37 @@ Expr TypeChecker::getTypeInternal(ExprValue* e, std::ostream* out)
     case Kind::APPLY:
     case Kind::APPLY_OPAQUE:
     {
+      std::vector<ExprValue*> args;
+      ExprValue* hd = getUncheckedSpine(e, args);
+      if (hd != nullptr)
+      {
+        Expr ret = getTypeSpineInternal(hd, args);
+        if (!ret.isNull())
+        {
+          return ret;
+        }
+        // Otherwise type check the partial applications, which reports the
+        // error if there is one.
+        Expr ehd((*e)[0]);
+        if (getType(ehd, out).isNull())
+        {
+          return d_null;
+        }
+      }
       Ctx ctx;
-      return getTypeAppInternal(e->d_children, ctx, out);
+      return getTypeAppInternal(e->getChildren(), ctx, out, true);
     }
     case Kind::LAMBDA:
     {
       std::vector<Expr> args;
-      std::vector<ExprValue*>& vars = e->d_children[0]->d_children;
+      ArrayView<ExprValue*> vars = (*e)[0]->getChildren();
       for (ExprValue* v : vars)
       {
         ExprValue* t = d_state.lookupType(v);
         Assert(t != nullptr);
         args.emplace_back(t);
       }
-      Expr ret(d_state.lookupType(e->d_children[1]));
+      Expr ret(d_state.lookupType((*e)[1]));
       Assert(!ret.isNull());
       return d_state.mkFunctionType(args, ret);
     }
@@ -243,7 +273,7 @@ Expr TypeChecker::getTypeInternal(ExprValue* e, std::ostream* out)
       return d_state.mkType();
     case Kind::PROOF_TYPE:
     {
-      ExprValue* ctype = d_state.lookupType(e->d_children[0]);
+      ExprValue* ctype = d_state.lookupType((*e)[0]);
       Assert(ctype != nullptr);
       if (ctype->getKind()!=Kind::BOOL_TYPE)
       {
@@ -260,7 +290,7 @@ Expr TypeChecker::getTypeInternal(ExprValue* e, std::ostream* out)
       return d_state.mkType();
     case Kind::OPAQUE_TYPE:
     {
-      ExprValue* ctype = d_state.lookupType(e->d_children[0]);
+      ExprValue* ctype = d_state.lookupType((*e)[0]);
       Assert(ctype != nullptr);
       if (ctype->getKind()!=Kind::TYPE)
       {
@@ -310,7 +340,7 @@ Expr TypeChecker::getTypeInternal(ExprValue* e, std::ostream* out)
     case Kind::PARAMETERIZED:
     {
       // type of the second child
-      return Expr(d_state.lookupType(e->d_children[1]));
+      return Expr(d_state.lookupType((*e)[1]));
     }
       break;
     default:
@@ -318,7 +348,7 @@ Expr TypeChecker::getTypeInternal(ExprValue* e, std::ostream* out)
       if (isLiteralOp(k))
       {
         std::vector<ExprValue*> ctypes;
-        std::vector<ExprValue*>& children = e->d_children;
+        ArrayView<ExprValue*> children = e->getChildren();
         for (ExprValue* c : children)
         {
           ctypes.push_back(d_state.lookupType(c));
@@ -334,20 +364,22 @@ Expr TypeChecker::getTypeInternal(ExprValue* e, std::ostream* out)
   return d_null;
 }
 
-Expr TypeChecker::getTypeApp(std::vector<Expr>& children, std::ostream* out)
+Expr TypeChecker::getTypeApp(ArrayView<Expr> children, std::ostream* out)
 {
   std::vector<ExprValue*> vchildren;
+  vchildren.reserve(children.size());
   for (const Expr& c : children)
   {
     vchildren.push_back(c.getValue());
   }
   Ctx ctx;
-  return getTypeAppInternal(vchildren, ctx, out);
+  return getTypeAppInternal(vchildren, ctx, out, true);
 }
 
-Expr TypeChecker::getTypeAppInternal(std::vector<ExprValue*>& children,
+Expr TypeChecker::getTypeAppInternal(ArrayView<ExprValue*> children,
                                      Ctx& ctx,
-                                     std::ostream* out)
+                                     std::ostream* out,
+                                     bool useCache)
 {
   Assert (!children.empty());
   ExprValue* hd = children[0];
@@ -362,7 +394,7 @@ Expr TypeChecker::getTypeAppInternal(std::vector<ExprValue*>& children,
     }
     return d_null;
   }
-  std::vector<ExprValue*> hdtypes = hdType->d_children;
+  ArrayView<ExprValue*> hdtypes = hdType->getChildren();
   std::vector<ExprValue*> ctypes;
   if (hdtypes.size() != children.size())
   {
@@ -394,6 +426,8 @@ Expr TypeChecker::getTypeAppInternal(std::vector<ExprValue*>& children,
       Assert(arg != nullptr);
     }
     ctypes.emplace_back(arg);
+    // if the argument is quoted, the type depends on the argument itself
+    useCache = useCache && hdtypes[i-1]->getKind()!=Kind::QUOTE_TYPE;
   }
   // if plugin can evaluate, run the compiled version of the type checker
   if (d_plugin!=nullptr && d_plugin->hasEvaluation(hdType))
@@ -401,7 +435,53 @@ Expr TypeChecker::getTypeAppInternal(std::vector<ExprValue*>& children,
     Trace("type_checker") << "RUN type check " << Expr(hdType) << std::endl;
     return d_plugin->getType(hdType, ctypes, out);
   }
-  std::set<std::pair<ExprValue*, ExprValue*>> visited;
+  // the type only depends on the function type and the argument types
+  std::vector<ExprValue*> key;
+  if (useCache && d_state.d_typeAppCache.isEnabled())
+  {
+    key.reserve(ctypes.size() + 1);
+    key.push_back(hdType);
+    key.insert(key.end(), ctypes.begin(), ctypes.end());
+    Expr cached;
+    // if the application is not well-typed, we recompute to report the error
+    if (d_state.d_typeAppCache.find(key, cached)
+        && (out == nullptr || !cached.isNull()))
+    {
+      return cached;
+    }
+  }
+  Expr ret = getTypeAppMatchInternal(hd, hdType, ctypes, ctx, out);
+  if (!key.empty())
+  {
+    d_state.d_typeAppCache.insert(key, ret);
+  }
+  return ret;
+}
+
+Expr TypeChecker::getTypeAppMatchInternal(ExprValue* hd,
+                                          ExprValue* hdType,
+                                          const std::vector<ExprValue*>& ctypes,
+                                          Ctx& ctx,
+                                          std::ostream* out)
+{
+  ArrayView<ExprValue*> hdtypes = hdType->getChildren();
+  // if the argument types do not require evaluation, use the compiled
+  // pattern. If it fails, we fall through to report the error below.
+  if (d_opts.d_bytecodeMatch)
+  {
+    const CompiledPattern* cp = d_state.getCompiledFunctionType(hdType);
+    if (cp != nullptr)
+    {
+      if (cp->run(ctypes.data(), ctx))
+      {
+        return evaluate(hdtypes.back(), ctx);
+      }
+      if (out == nullptr)
+      {
+        return d_null;
+      }
+    }
+  }
   Expr hdEval;
   for (size_t i=0, nchild=ctypes.size(); i<nchild; i++)
   {
@@ -411,14 +491,14 @@ Expr TypeChecker::getTypeAppInternal(std::vector<ExprValue*>& children,
     // if the argument is (Quote t), we match on its argument,
     // which along with how ctypes[i] is the argument itself, has the effect
     // of an implicit upcast.
-    hdt = hdt->getKind() == Kind::QUOTE_TYPE ? hdt->d_children[0] : hdt;
+    hdt = hdt->getKind() == Kind::QUOTE_TYPE ? (*hdt)[0] : hdt;
     // must evaluate here
     if (hdt->isEvaluatable())
     {
       hdEval = evaluate(hdt, ctx);
       hdt = hdEval.getValue();
     }
-    if (!match(hdt, ctypes[i], ctx, visited))
+    if (!match(hdt, ctypes[i], ctx))
     {
       if (out)
       {
@@ -436,24 +516,155 @@ Expr TypeChecker::getTypeAppInternal(std::vector<ExprValue*>& children,
   return evaluate(hdtypes.back(), ctx);
 }
 
-bool TypeChecker::match(ExprValue* a, ExprValue* b, Ctx& ctx)
+ExprValue* TypeChecker::getUncheckedSpine(ExprValue* e,
+                                          std::vector<ExprValue*>& args)
 {
-  std::set<std::pair<ExprValue*, ExprValue*>> visited;
-  return match(a, b, ctx, visited);
+  // the plugin type checks each application by the type of its head
+  if (d_plugin != nullptr || e->getKind() != Kind::APPLY
+      || e->getNumChildren() != 2)
+  {
+    return nullptr;
+  }
+  ExprValue* hd = (*e)[0];
+  size_t nargs = args.size();
+  args.push_back((*e)[1]);
+  while (hd->getKind() == Kind::APPLY && hd->getNumChildren() == 2
+         && d_state.lookupType(hd) == nullptr)
+  {
+    args.push_back((*hd)[1]);
+    hd = (*hd)[0];
+  }
+  if (args.size() - nargs < 2)
+  {
+    // the head of e is not an application, or has been type checked
+    args.resize(nargs);
+    return nullptr;
+  }
+  return hd;
 }
 
-bool TypeChecker::match(ExprValue* a,
-                        ExprValue* b,
-                        Ctx& ctx,
-                        std::set<std::pair<ExprValue*, ExprValue*>>& visited)
+Expr TypeChecker::getTypeSpineInternal(ExprValue* hd,
+                                       const std::vector<ExprValue*>& args)
 {
-  std::set<std::pair<ExprValue*, ExprValue*>>::iterator it;
-  std::map<ExprValue*, ExprValue*>::iterator ctxIt;
+  ExprValue* hdType = d_state.lookupType(hd);
+  Assert(hdType != nullptr) << "No type for " << Expr(hd);
+  // The type of the head followed by the argument types, in order, is the
+  // key for the cache of application types. We only use the cache if the
+  // argument types are ground, where matching in a single context is the
+  // same as in getTypeAppInternal.
+  std::vector<ExprValue*> key;
+  key.reserve(args.size() + 1);
+  key.push_back(hdType);
+  bool useCache = d_state.d_typeAppCache.isEnabled();
+  for (size_t i = args.size(); i > 0; i--)
+  {
+    ExprValue* ct = d_state.lookupType(args[i - 1]);
+    Assert(ct != nullptr);
+    useCache = useCache && ct->isGround();
+    key.push_back(ct);
+  }
+  Expr cached;
+  if (useCache && d_state.d_typeAppCache.find(key, cached))
+  {
+    return cached;
+  }
+  bool hasQuote = false;
+  Expr ftype(hdType);
+  Expr hdEval;
+  Ctx ctx;
+  // the arguments are stored in reverse order
+  for (size_t i = args.size(); i > 0; i--)
+  {
+    ExprValue* ft = ftype.getValue();
+    if (ft->getKind() != Kind::FUNCTION_TYPE)
+    {
+      // The remainder of the function type is given by evaluation, e.g. it
+      // has requires. This is the type of the partial application, and we
+      // continue with it in a new context.
+      ftype = evaluate(ft, ctx);
+      ft = ftype.getValue();
+      if (ft->getKind() != Kind::FUNCTION_TYPE || ftype.isEvaluatable())
+      {
+        return d_null;
+      }
+      ctx.clear();
+    }
+    if (ft->getNumChildren() != 2)
+    {
+      return d_null;
+    }
+    ExprValue* hdt = (*ft)[0];
+    ExprValue* arg = args[i - 1];
+    // as in getTypeAppInternal, (Quote t) is matched against the argument
+    if (hdt->getKind() == Kind::QUOTE_TYPE)
+    {
+      hdt = (*hdt)[0];
+      hasQuote = true;
+    }
+    else
+    {
+      arg = d_state.lookupType(arg);
+      Assert(arg != nullptr);
+    }
+    // Matching in a single context is only the same as matching each
+    // argument against the instantiated type of the partial application
+    // if the argument is ground.
+    if (!arg->isGround())
+    {
+      return d_null;
+    }
+    if (hdt->isEvaluatable())
+    {
+      hdEval = evaluate(hdt, ctx);
+      hdt = hdEval.getValue();
+    }
+    if (!match(hdt, arg, ctx))
+    {
+      return d_null;
+    }
+    ftype = Expr((*ft)[1]);
+  }
+  Expr ret = evaluate(ftype.getValue(), ctx);
+  // failures are not cached, since they are reported by type checking the
+  // partial applications
+  if (useCache && !hasQuote && !ret.isNull())
+  {
+    d_state.d_typeAppCache.insert(key, ret);
+  }
+  return ret;
+}
 
-  std::vector<std::pair<ExprValue*, ExprValue*>> stack;
+bool TypeChecker::match(ExprValue* a, ExprValue* b, Ctx& ctx)
+{
+  if (a == b)
+  {
+    return true;
+  }
+  if (a->isGround())
+  {
+    return false;
+  }
+  // we only need to remember the pairs we visited if a may have shared
+  // non-ground subterms
+  bool checkVisited = isNonLinear(a);
+  if (checkVisited)
+  {
+    d_matchVisited.clear();
+    // clearing is linear in the number of buckets, hence we release the
+    // buckets once they are many, e.g. after matching a large term
+    if (d_matchVisited.bucket_count() > 1024)
+    {
+      d_matchVisited.rehash(0);
+    }
+  }
+  std::vector<std::pair<ExprValue*, ExprValue*>>& stack = d_matchStack;
+  stack.clear();
   stack.emplace_back(a, b);
   std::pair<ExprValue*, ExprValue*> curr;
-
+  Ctx::iterator ctxIt;
+  // the parameters bound by this call are added to ctx, and removed again if
+  // we fail to match
+  size_t nbinds = ctx.size();
   while (!stack.empty())
   {
     curr = stack.back();
@@ -463,37 +674,34 @@ bool TypeChecker::match(ExprValue* a,
       // holds trivially
       continue;
     }
-    it = visited.find(curr);
-    if (it != visited.end())
+    if (curr.first->isGround())
+    {
+      // since terms are hash-consed, a distinct ground pattern cannot match
+      ctx.resize(nbinds);
+      return false;
+    }
+    if (checkVisited && !d_matchVisited.insert(curr).second)
     {
       // already processed
       continue;
     }
-    visited.insert(curr);
     if (curr.first->getNumChildren() == 0)
     {
       // if the two subterms are not equal and the first one is a bound
-      // variable...
-      if (curr.first->getKind() == Kind::PARAM)
+      // variable, it is a parameter since it is not ground
+      Assert(curr.first->getKind() == Kind::PARAM);
+      // look up whether it is bound, in this call or before
+      ctxIt = ctx.find(curr.first);
+      if (ctxIt == ctx.end())
       {
-        // and we have not seen this variable before...
-        ctxIt = ctx.find(curr.first);
-        if (ctxIt == ctx.cend())
-        {
-          // note that we do not ensure the types match here
-          // add the two subterms to `sub`
-          ctx.emplace(curr.first, curr.second);
-        }
-        else if (ctxIt->second!=curr.second)
-        {
-          // if we saw this variable before, make sure that (now and before) it
-          // maps to the same subterm
-          return false;
-        }
+        // note that we do not ensure the types match here
+        ctx.bind(curr.first, curr.second);
       }
-      else
+      else if (ctxIt->second != curr.second)
       {
-        // the two subterms are not equal
+        // if we saw this variable before, make sure that (now and before) it
+        // maps to the same subterm
+        ctx.resize(nbinds);
         return false;
       }
     }
@@ -504,6 +712,7 @@ bool TypeChecker::match(ExprValue* a,
       if (curr.first->getNumChildren() != curr.second->getNumChildren()
           || curr.first->getKind() != curr.second->getKind())
       {
+        ctx.resize(nbinds);
         return false;
       }
       // recurse on children
@@ -516,29 +725,153 @@ bool TypeChecker::match(ExprValue* a,
   return true;
 }
 
+bool TypeChecker::isNonLinear(ExprValue* p)
+{
+  if (p->getFlag(ExprValue::Flag::IS_LINEARITY_COMPUTED))
+  {
+    return p->getFlag(ExprValue::Flag::IS_NON_LINEAR);
+  }
+  // A shared non-ground subterm contains a parameter that we see twice, hence
+  // we stop at the first repeated parameter before traversing it again.
+  bool nonLinear = false;
+  std::unordered_set<ExprValue*> params;
+  std::vector<ExprValue*> toVisit;
+  toVisit.push_back(p);
+  while (!toVisit.empty())
+  {
+    ExprValue* cur = toVisit.back();
+    toVisit.pop_back();
+    if (cur->isGround())
+    {
+      continue;
+    }
+    if (cur->getNumChildren() == 0)
+    {
+      if (!params.insert(cur).second)
+      {
+        nonLinear = true;
+        break;
+      }
+      continue;
+    }
+    for (ExprValue* c : cur->getChildren())
+    {
+      toVisit.push_back(c);
+    }
+  }
+  p->setFlag(ExprValue::Flag::IS_LINEARITY_COMPUTED, true);
+  p->setFlag(ExprValue::Flag::IS_NON_LINEAR, nonLinear);
+  return nonLinear;
+}
+
 /** Evaluation frame, used in evaluate below. */
 class EvFrame
 {
  public:
-  EvFrame(ExprValue* i, Ctx& ctx, ExprTrie* r) : d_init(i), d_ctx(ctx), d_result(r) {
+  EvFrame(ExprValue* i,
+          Ctx* ctx,
+          std::unique_ptr<EvalVisitedCache> visited,
+          ExprTrie* r,
+          std::vector<ExprValue*>&& cacheKey,
+          size_t tempStart)
+      : d_init(i),
+        d_extCtx(ctx),
+        d_visited(std::move(visited)),
+        d_result(r),
+        d_cacheKey(std::move(cacheKey)),
+        d_tempStart(tempStart)
+  {
     if (d_init!=nullptr)
     {
       d_visit.push_back(d_init);
     }
   }
-  ~EvFrame(){}
+  /** Get the context the initial value is being evaluated in */
+  Ctx& getContext() { return d_extCtx != nullptr ? *d_extCtx : d_ctx; }
   /** The initial value we are evaluating */
   ExprValue* d_init;
-  /** The context it is being evaluated in */
+  /**
+   * The context it is being evaluated in if it is owned by the caller of
+   * evaluate, or null if it is d_ctx. Frames are moved when the evaluation
+   * stack grows, hence we do not point to d_ctx.
+   */
+  Ctx* d_extCtx;
+  /** The context of a program call, moved from its matching */
   Ctx d_ctx;
-  /** Cache of visited subterms */
-  std::unordered_map<ExprValue*, Expr> d_visited;
+  /** Cache of visited subterms, taken from the pool of the type checker */
+  std::unique_ptr<EvalVisitedCache> d_visited;
   /** The subterms to visit */
   std::vector<ExprValue*> d_visit;
   /** An (optional) pointer of a trie of where to store the result */
   ExprTrie * d_result;
+  /**
+   * The program application whose result this is, if it should be stored in
+   * the evaluation cache of the state, or empty otherwise.
+   */
+  std::vector<ExprValue*> d_cacheKey;
+  /** The number of temporary terms in use when this frame was pushed */
+  size_t d_tempStart;
 };
 
+ExprValue* TypeChecker::mkTemporary(const Literal& l)
+{
+  if (d_numTemps == d_temps.size())
+  {
+    d_temps.emplace_back(new Literal(l));
+  }
+  else
+  {
+    *d_temps[d_numTemps] = l;
+  }
+  Literal* t = d_temps[d_numTemps].get();
+  d_numTemps++;
+  // temporary terms are not reference counted, they are counted by tempCount
+  // and not by immortalCount
+  t->setFlag(ExprValue::Flag::IS_IMMORTAL, true);
+  d_state.getStats().d_tempCount++;
+  return t;
+}
+
+bool TypeChecker::isTemporary(const ExprValue* e)
+{
+  // identifier 0 is only used for the null term and temporary terms
+  return e->d_id == 0 && e->getKind() != Kind::NONE;
+}
+
+ExprValue* TypeChecker::internTemporary(ExprValue* e)
+{
+  if (!isTemporary(e))
+  {
+    return e;
+  }
+  // it was not avoided after all
+  d_state.getStats().d_tempCount--;
+  return d_state.mkLiteralInternal(*static_cast<Literal*>(e));
+}
+
+std::unique_ptr<EvalVisitedCache> TypeChecker::allocVisitedCache()
+{
+  if (d_visitedPool.empty())
+  {
+    return std::unique_ptr<EvalVisitedCache>(new EvalVisitedCache);
+  }
+  std::unique_ptr<EvalVisitedCache> ret = std::move(d_visitedPool.back());
+  d_visitedPool.pop_back();
+  return ret;
+}
+
+void TypeChecker::freeVisitedCache(std::unique_ptr<EvalVisitedCache> vc)
+{
+  // Clearing takes time linear in the number of buckets, hence we do not keep
+  // caches that grew large, since they would slow down small evaluations.
+  if (vc->bucket_count() > 1024)
+  {
+    return;
+  }
+  vc->clear();
+  d_visitedPool.push_back(std::move(vc));
+}
+
 Expr TypeChecker::evaluate(ExprValue* e, Ctx& ctx)
 {
   Assert (e!=nullptr);
@@ -551,11 +884,16 @@ Expr TypeChecker::evaluate(ExprValue* e, Ctx& ctx)
   // appear in the above trie.
   std::unordered_set<ExprValue*> keep;
   std::vector<Expr> keepList;
-  std::unordered_map<ExprValue*, Expr>::iterator it;
+  EvalVisitedCache::iterator it;
   Ctx::iterator itc;
   // the evaluation stack
   std::vector<EvFrame> estack;
-  estack.emplace_back(e, ctx, nullptr);
+  estack.emplace_back(e,
+                      &ctx,
+                      allocVisitedCache(),
+                      nullptr,
+                      std::vector<ExprValue*>(),
+                      d_numTemps);
   Expr evaluated;
   ExprValue* cur;
   Kind ck;
@@ -564,9 +902,9 @@ Expr TypeChecker::evaluate(ExprValue* e, Ctx& ctx)
   while (!estack.empty())
   {
     EvFrame& evf = estack.back();
-    std::unordered_map<ExprValue*, Expr>& visited = evf.d_visited;
+    EvalVisitedCache& visited = *evf.d_visited;
     std::vector<ExprValue*>& visit = evf.d_visit;
-    Ctx& cctx = evf.d_ctx;
+    Ctx& cctx = evf.getContext();
     while (!visit.empty())
     {
       Assert (!newContext && canEvaluate);
@@ -599,7 +937,7 @@ Expr TypeChecker::evaluate(ExprValue* e, Ctx& ctx)
         //std::cout << "WARNING: unfilled variable " << cur << std::endl;
       }
       ck = cur->getKind();
-      std::vector<ExprValue*>& children = cur->d_children;
+      ArrayView<ExprValue*> children = cur->getChildren();
       it = visited.find(cur);
       if (it == visited.end())
       {
@@ -643,11 +981,18 @@ Expr TypeChecker::evaluate(ExprValue* e, Ctx& ctx)
       {
         std::vector<ExprValue*> cchildren;
         bool cchanged = false;
+        // literal operators that only depend on the values of their
+        // arguments may take temporary terms as arguments
+        bool valueOp = isValueLiteralOp(ck);
         for (ExprValue* cp : children)
         {
           it = visited.find(cp);
           if (it != visited.end())
           {
+            if (!valueOp && isTemporary(it->second.getValue()))
+            {
+              it->second = Expr(internTemporary(it->second.getValue()));
+            }
             cchildren.push_back(it->second.getValue());
             if (!cchanged)
             {
@@ -682,12 +1027,33 @@ Expr TypeChecker::evaluate(ExprValue* e, Ctx& ctx)
                 }
               }
               ExprTrie* et = evalTrie.get(cchildren);
+              // programs on ground arguments may be cached across calls to
+              // this method, oracles are never cached.
+              bool cacheable = cck == Kind::PROGRAM_CONST
+                               && d_state.d_evalCache.isEnabled()
+                               && !d_state.isProgramUncached(cchildren[0])
+                               && isGround(cchildren);
               if (et->d_data!=nullptr)
               {
                 evaluated = Expr(et->d_data);
                 Trace("type_checker_debug")
                     << "evaluated via cached evaluation" << std::endl;
               }
+              else if (cacheable
+                       && d_state.d_evalCache.find(cchildren, evaluated))
+              {
+                if (!evaluated.isNull())
+                {
+                  ExprValue* ev = evaluated.getValue();
+                  if (keep.insert(ev).second)
+                  {
+                    keepList.emplace_back(ev);
+                  }
+                  et->d_data = ev;
+                }
+                Trace("type_checker_debug")
+                    << "evaluated via evaluation cache" << std::endl;
+              }
               else
               {
                 Ctx newCtx;
@@ -700,12 +1066,25 @@ Expr TypeChecker::evaluate(ExprValue* e, Ctx& ctx)
                   // push a context
                   // store the base evaluation (if applicable)
                   et->d_data = evaluated.getValue();
+                  if (cacheable)
+                  {
+                    d_state.d_evalCache.insert(cchildren, evaluated);
+                  }
                 }
                 else
                 {
-                  // otherwise push an evaluation scope
+                  // otherwise push an evaluation scope, which takes the
+                  // context of the program call
                   newContext = true;
-                  estack.emplace_back(evaluated.getValue(), newCtx, et);
+                  estack.emplace_back(
+                      evaluated.getValue(),
+                      nullptr,
+                      allocVisitedCache(),
+                      et,
+                      cacheable ? std::move(cchildren)
+                                : std::vector<ExprValue*>(),
+                      d_numTemps);
+                  estack.back().d_ctx.swap(newCtx);
                 }
               }
             }
@@ -754,7 +1133,7 @@ Expr TypeChecker::evaluate(ExprValue* e, Ctx& ctx)
           default:
             if (isLiteralOp(ck))
             {
-              evaluated = evaluateLiteralOpInternal(ck, cchildren);
+              evaluated = evaluateLiteralOpInternal(ck, cchildren, valueOp);
               Trace("type_checker_debug")
                   << "evaluated via literal op" << std::endl;
             }
@@ -771,6 +1150,13 @@ Expr TypeChecker::evaluate(ExprValue* e, Ctx& ctx)
           {
             if (cchanged)
             {
+              if (valueOp)
+              {
+                for (ExprValue*& cc : cchildren)
+                {
+                  cc = internTemporary(cc);
+                }
+              }
               evaluated = Expr(d_state.mkExprInternal(ck, cchildren));
             }
             else
@@ -802,10 +1188,11 @@ Expr TypeChecker::evaluate(ExprValue* e, Ctx& ctx)
     {
       // get the result from the inner evaluation
       ExprValue* init = evf.d_init;
-      Assert (evf.d_visited.find(init)!=evf.d_visited.end());
-      evaluated = evf.d_visited[init];
+      Assert (evf.d_visited->find(init)!=evf.d_visited->end());
+      evaluated = Expr(internTemporary((*evf.d_visited)[init].getValue()));
       Trace("type_checker") << "EVALUATE " << Expr(init) << ", "
-                            << evf.d_ctx << " = " << evaluated << std::endl;
+                            << evf.getContext() << " = " << evaluated
+                            << std::endl;
       if (evf.d_result!=nullptr)
       {
         ExprValue * ev = evaluated.getValue();
@@ -815,14 +1202,20 @@ Expr TypeChecker::evaluate(ExprValue* e, Ctx& ctx)
         }
         evf.d_result->d_data = ev;
       }
+      if (!evf.d_cacheKey.empty())
+      {
+        d_state.d_evalCache.insert(evf.d_cacheKey, evaluated);
+      }
       // pop the evaluation context
+      freeVisitedCache(std::move(evf.d_visited));
+      d_numTemps = evf.d_tempStart;
       estack.pop_back();
       // carry to lower context
       if (!estack.empty())
       {
         EvFrame& evp = estack.back();
         Assert (!evp.d_visit.empty());
-        evp.d_visited[evp.d_visit.back()] = evaluated;
+        (*evp.d_visited)[evp.d_visit.back()] = evaluated;
         evp.d_visit.pop_back();
       }
     }
@@ -881,14 +1274,21 @@ Expr TypeChecker::evaluateProgramInternal(
     if (!prog.isNull())
     {
       Trace("type_checker") << "INTERPRET program " << children << std::endl;
-      // otherwise, evaluate
-      for (size_t i = 0, nchildren = prog.getNumChildren(); i < nchildren;
-           i++)
+      Stats& stats = d_state.getStats();
+      stats.d_progEvalCount++;
+      // otherwise, evaluate, only trying the cases that may match
+      const CaseIndex* ci = d_state.getCaseIndex(hd);
+      Assert(ci != nullptr);
+      const std::vector<size_t>& cases = ci->getCandidates(children);
+      const std::vector<std::unique_ptr<CompiledPattern>>* compiled =
+          d_opts.d_bytecodeMatch ? &d_state.getCompiledProgram(hd) : nullptr;
+      for (size_t i : cases)
       {
+        stats.d_progCaseCount++;
         const Expr& c = prog[i];
         newCtx.clear();
         ExprValue* hd = c[0].getValue();
-        std::vector<ExprValue*>& hchildren = hd->d_children;
+        ArrayView<ExprValue*> hchildren = hd->getChildren();
         if (nargs != hchildren.size())
         {
           // TODO: catch this during weak type checking of program bodies
@@ -897,12 +1297,19 @@ Expr TypeChecker::evaluateProgramInternal(
           return d_null;
         }
         bool matchSuccess = true;
-        for (size_t i=1; i<nargs; i++)
+        if (compiled != nullptr)
+        {
+          matchSuccess = (*compiled)[i]->run(children.data() + 1, newCtx);
+        }
+        else
         {
-          if (!match(hchildren[i], children[i], newCtx))
+          for (size_t j = 1; j < nargs; j++)
           {
-            matchSuccess = false;
-            break;
+            if (!match(hchildren[j], children[j], newCtx))
+            {
+              matchSuccess = false;
+              break;
+            }
           }
         }
         if (matchSuccess)
@@ -986,48 +1393,21 @@ Expr TypeChecker::evaluateLiteralOp(Kind k,
 }
 
 /**
- * Get nary children, gets a list of children from op-application e
- * up to maxChildren (0 means no limit), stores them in children.
+ * Check that the list v, which is the flattened view of e, ends with the nil
+ * term nil, and warn if not.
  */
-ExprValue* getNAryChildren(ExprValue* e,
-                           ExprValue* op,
-                           ExprValue* checkNil,
-                           std::vector<ExprValue*>& children,
-                           bool isLeft,
-                           size_t maxChildren=0)
+bool checkListEnd(const ListView& v, ExprValue* nil, ExprValue* e)
 {
-  ExprValue* orig = e;
-  while (e->getKind()==Kind::APPLY)
-  {
-    ExprValue* cop = (*e)[0];
-    if (cop->getKind()!=Kind::APPLY)
-    {
-      break;
-    }
-    if ((*cop)[0] != op)
-    {
-      break;
-    }
-    // push back the element
-    children.push_back(isLeft ? (*e)[1] : (*cop)[1]);
-    // traverse to tail
-    e = isLeft ? (*cop)[1] : (*e)[1];
-    if (children.size()==maxChildren)
-    {
-      return e;
-    }
-  }
-  // must be equal to the nil term, if provided
-  if (checkNil!=nullptr && e!=checkNil)
+  if (v.getEnd() != nil)
   {
-    Warning() << "...expected associative application to end in " << Expr(checkNil) << ", got " << Expr(orig) << std::endl;
-    return nullptr;
+    Warning() << "...expected associative application to end in " << Expr(nil) << ", got " << Expr(e) << std::endl;
+    return false;
   }
-  return e;
+  return true;
 }
 
 Expr TypeChecker::evaluateLiteralOpInternal(
-    Kind k, const std::vector<ExprValue*>& args)
+    Kind k, const std::vector<ExprValue*>& args, bool allowTemp)
 {
   Assert (!args.empty());
   Trace("type_checker") << "EVALUATE-LIT " << k << " " << args << std::endl;
@@ -1214,8 +1594,11 @@ Expr TypeChecker::evaluateLiteralOpInternal(
       // failed to evaluate
       return d_null;
     }
-    // convert back to an expression
-    Expr lit = Expr(d_state.mkLiteralInternal(eval));
+    // convert back to an expression, which is only interned when it is
+    // used other than as the argument of a literal operator
+    Expr lit = Expr(allowTemp && eval.getKind() != Kind::BOOLEAN
+                        ? mkTemporary(eval)
+                        : d_state.mkLiteralInternal(eval));
     Trace("type_checker") << "...value-evaluates to " << lit << std::endl;
     return lit;
   }
@@ -1243,13 +1626,9 @@ Expr TypeChecker::evaluateLiteralOpInternal(
   bool isLeft = (ck==Attr::LEFT_ASSOC_NIL);
   Trace("type_checker_debug") << "EVALUATE-LIT (list) " << k << " " << isLeft << " " << args << std::endl;
   // infer the nil expression, which depends on the type of args[1]
-  std::vector<Expr> eargs;
-  eargs.emplace_back(args[0]);
-  if (args.size()>1)
-  {
-    eargs.emplace_back(args[1]);
-  }
-  Expr nilExpr = computeConstructorTermInternal(ac, eargs);
+  Expr eargs[2] = {Expr(args[0]), Expr(args.size() > 1 ? args[1] : nullptr)};
+  Expr nilExpr = computeConstructorTermInternal(
+      ac, ArrayView<Expr>(eargs, args.size() > 1 ? 2 : 1));
   if (nilExpr.isNull())
   {
     Trace("type_checker") << "...failed to get nil" << std::endl;
@@ -1270,9 +1649,8 @@ Expr TypeChecker::evaluateLiteralOpInternal(
     case Kind::EVAL_CONS:
     case Kind::EVAL_LIST_CONCAT:
     {
-      std::vector<ExprValue*> targs;
-      ExprValue* b = getNAryChildren(args[tailIndex], op, nil, targs, isLeft);
-      if (b==nullptr)
+      ListView tv = d_state.d_listCache.get(args[tailIndex], op, isLeft);
+      if (!checkListEnd(tv, nil, args[tailIndex]))
       {
         Trace("type_checker") << "...tail not in list form, nil is " << nilExpr << std::endl;
         // tail is not in list form
@@ -1285,13 +1663,17 @@ Expr TypeChecker::evaluateLiteralOpInternal(
       else
       {
         // extract all children of the head
-        ExprValue* a = getNAryChildren(args[headIndex], op, nil, hargs, isLeft);
-        if (a==nullptr)
+        ListView hv = d_state.d_listCache.get(args[headIndex], op, isLeft);
+        if (!checkListEnd(hv, nil, args[headIndex]))
         {
           Trace("type_checker") << "...head not in list form" << std::endl;
           // head is not in list form
           return d_null;
         }
+        for (size_t i = 0, nelems = hv.size(); i < nelems; i++)
+        {
+          hargs.push_back(hv[i]);
+        }
       }
       // note we take the tail verbatim
       ret = args[tailIndex];
@@ -1299,13 +1681,13 @@ Expr TypeChecker::evaluateLiteralOpInternal(
       break;
     case Kind::EVAL_LIST_LENGTH:
     {
-      ExprValue* a = getNAryChildren(args[1], op, nil, hargs, isLeft);
-      if (a==nullptr)
+      ListView v = d_state.d_listCache.get(args[1], op, isLeft);
+      if (!checkListEnd(v, nil, args[1]))
       {
         Trace("type_checker") << "...head not in list form" << std::endl;
         return d_null;
       }
-      Literal lret = Literal(Integer(hargs.size()));
+      Literal lret = Literal(Integer(v.size()));
       return Expr(d_state.mkLiteralInternal(lret));
     }
       break;
@@ -1322,20 +1704,26 @@ Expr TypeChecker::evaluateLiteralOpInternal(
         return d_null;
       }
       size_t i = index.toUnsignedInt();
-      // extract up to i+1 children
-      getNAryChildren(args[1], op, nil, hargs, isLeft, i+1);
-      if (hargs.size()==i+1)
+      ListView v = d_state.d_listCache.get(args[1], op, isLeft);
+      if (i < v.size())
       {
-        return Expr(hargs.back());
+        return Expr(v[i]);
       }
+      checkListEnd(v, nil, args[1]);
       return d_null;
     }
       break;
     case Kind::EVAL_LIST_FIND:
     {
-      getNAryChildren(args[1], op, nil, hargs, isLeft);
-      std::vector<ExprValue*>::iterator it = std::find(hargs.begin(), hargs.end(), args[2]);
-      if (it==hargs.end())
+      ListView v = d_state.d_listCache.get(args[1], op, isLeft);
+      checkListEnd(v, nil, args[1]);
+      size_t iret = 0;
+      size_t nelems = v.size();
+      while (iret < nelems && v[iret] != args[2])
+      {
+        iret++;
+      }
+      if (iret == nelems)
       {
         if (d_negOne.isNull())
         {
@@ -1344,7 +1732,6 @@ Expr TypeChecker::evaluateLiteralOpInternal(
         }
         return d_negOne;
       }
-      size_t iret = std::distance(hargs.begin(), it);
       Literal lret = Literal(Integer(iret));
       return Expr(d_state.mkLiteralInternal(lret));
     }
@@ -1369,7 +1756,7 @@ Expr TypeChecker::evaluateLiteralOpInternal(
 }
 
 ExprValue* TypeChecker::getLiteralOpType(Kind k,
-                                         std::vector<ExprValue*>& children,
+                                         ArrayView<ExprValue*> children,
                                          std::vector<ExprValue*>& childTypes,
                                          std::ostream* out)
 {
@@ -1448,8 +1835,8 @@ ExprValue* TypeChecker::getLiteralOpType(Kind k,
   return nullptr;
 }
 
-Expr TypeChecker::computeConstructorTermInternal(AppInfo* ai, 
-                                                 const std::vector<Expr>& children)
+Expr TypeChecker::computeConstructorTermInternal(AppInfo* ai,
+                                                 ArrayView<Expr> children)
 {
   Expr hd;
   Expr nil;
@@ -1458,7 +1845,7 @@ Expr TypeChecker::computeConstructorTermInternal(AppInfo* ai,
 }
 
 bool TypeChecker::computedParameterizedInternal(AppInfo* ai,
-                                                const std::vector<Expr>& children,
+                                                ArrayView<Expr> children,
                                                 Expr& hd,
                                                 Expr& nil)
 {
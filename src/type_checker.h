@@ -10,8 +10,12 @@
 #define TYPE_CHECKER_H
 
 #include <map>
+#include <memory>
 #include <set>
+#include <unordered_map>
+#include <unordered_set>
 #include "expr.h"
+#include "expr_hash.h"
 #include "expr_trie.h"
 #include "expr_info.h"
 
@@ -21,6 +25,9 @@ class State;
 class Options;
 class Plugin;
 
+/** The cache of the evaluated subterms of an evaluation frame */
+using EvalVisitedCache = std::unordered_map<ExprValue*, Expr>;
+
 /** 
  * The type checker for Ethos. The main algorithms it implements are
  * getType, match, and evaluate.
@@ -37,12 +44,12 @@ class TypeChecker
    * is not well-typed. In this case, an error message is written on
    * out if it is provided.
    */
-  Expr getType(Expr& e, std::ostream* out = nullptr);
+  Expr getType(const Expr& e, std::ostream* out = nullptr);
   /**
    * Get the type of an application, equivalent to calling getType on
    * (APPLY children).
    */
-  Expr getTypeApp(std::vector<Expr>& children, std::ostream* out = nullptr);
+  Expr getTypeApp(ArrayView<Expr> children, std::ostream* out = nullptr);
   /**
    * Check arity for kind, returns false if k cannot be applied to nargs.
    */
@@ -77,19 +84,37 @@ class TypeChecker
   Expr evaluateLiteralOp(Kind k, const std::vector<ExprValue*>& args);
  private:
   /**
-   * Match expression a with b. If this returns true, then ctx is a substitution
-   * that when applied to b gives a. The substitution
+   * Match expression a with b. If this returns true, then ctx is extended
+   * with a substitution such that applying ctx to a gives b. Otherwise, ctx
+   * is unchanged.
    */
   bool match(ExprValue* a, ExprValue* b, Ctx& ctx);
-  /** Same as above, but takes a cache of pairs we have already visited */
-  bool match(ExprValue* a,
-             ExprValue* b,
-             Ctx& ctx,
-             std::set<std::pair<ExprValue*, ExprValue*>>& visited);
-  /** */
-  Expr getTypeAppInternal(std::vector<ExprValue*>& children,
+  /**
+   * Does a parameter occur more than once in the pattern p? Only then may
+   * matching visit the same pair of subterms more than once.
+   */
+  static bool isNonLinear(ExprValue* p);
+  /**
+   * Get the type of the application whose children are given, where ctx is
+   * extended with the context computed by matching the argument types.
+   *
+   * If useCache is true, the type is looked up in the cache of application
+   * types of State and stored there, unless the head has quoted arguments. In
+   * this case, ctx is not extended if the type was cached.
+   */
+  Expr getTypeAppInternal(ArrayView<ExprValue*> children,
                           Ctx& ctx,
-                          std::ostream* out = nullptr);
+                          std::ostream* out = nullptr,
+                          bool useCache = false);
+  /**
+   * Get the type of an application of hd, whose type is the function type
+   * hdType, to arguments whose types are ctypes, by matching.
+   */
+  Expr getTypeAppMatchInternal(ExprValue* hd,
+                               ExprValue* hdType,
+                               const std::vector<ExprValue*>& ctypes,
+                               Ctx& ctx,
+                               std::ostream* out);
   /** Are all args ground? */
   static bool isGround(const std::vector<ExprValue*>& args);
   /** Maybe evaluate */
@@ -97,25 +122,67 @@ class TypeChecker
                               Ctx& newCtx);
   /** Return its type */
   Expr getTypeInternal(ExprValue* e, std::ostream* out);
+  /**
+   * If e is a curried application whose head is an application that has not
+   * been type checked, return the head of its spine, i.e. the first
+   * application along the heads of e that has been type checked, or the first
+   * head that is not an application, and add the arguments along the spine to
+   * args in reverse order. Otherwise return nullptr.
+   */
+  ExprValue* getUncheckedSpine(ExprValue* e, std::vector<ExprValue*>& args);
+  /**
+   * Get the type of the curried application e in one pass over its spine, as
+   * computed by getUncheckedSpine, where all arguments and the head of the
+   * spine have been type checked. This matches the arguments against the
+   * types of the curried function type of the head in a single context,
+   * without computing the types of the partial applications along the spine.
+   *
+   * @return The type of e, or null if this failed, in which case the type of
+   * e should be computed by type checking its partial applications.
+   */
+  Expr getTypeSpineInternal(ExprValue* hd,
+                            const std::vector<ExprValue*>& args);
   /** Get or set type rule (to default) for literal kind k */
   ExprValue* getOrSetLiteralTypeRule(Kind k);
-  /** Evaluate literal op */
-  Expr evaluateLiteralOpInternal(Kind k, const std::vector<ExprValue*>& args);
+  /**
+   * Evaluate literal op. If allowTemp is true and the result is a value other
+   * than a Boolean, it may be a temporary term, see mkTemporary.
+   */
+  Expr evaluateLiteralOpInternal(Kind k,
+                                 const std::vector<ExprValue*>& args,
+                                 bool allowTemp = false);
+  /**
+   * Make a temporary term for the literal l. Temporary terms are not interned
+   * and are not reference counted. They are used for the intermediate values
+   * of literal operators within evaluate, and are reused once the evaluation
+   * frame that made them is finished. They must be interned via
+   * internTemporary before they are used in any other way.
+   */
+  ExprValue* mkTemporary(const Literal& l);
+  /** Is e a temporary term? */
+  static bool isTemporary(const ExprValue* e);
+  /** Get the interned term for e if it is temporary, or e otherwise */
+  ExprValue* internTemporary(ExprValue* e);
   /** Type check */
   ExprValue* getLiteralOpType(Kind k,
-                              std::vector<ExprValue*>& children,
+                              ArrayView<ExprValue*> children,
                               std::vector<ExprValue*>& childTypes,
                               std::ostream* out);
   /** Get the nil terminator */
-  Expr computeConstructorTermInternal(AppInfo* ai,
-                                      const std::vector<Expr>& children);
+  Expr computeConstructorTermInternal(AppInfo* ai, ArrayView<Expr> children);
+  /** Get an empty visited cache for an evaluation frame */
+  std::unique_ptr<EvalVisitedCache> allocVisitedCache();
+  /** Return the visited cache of a finished evaluation frame to the pool */
+  void freeVisitedCache(std::unique_ptr<EvalVisitedCache> vc);
   /** Returns the (possibly disambiguated) operator in children and its nil terminator */
   bool computedParameterizedInternal(AppInfo* ai,
-                                     const std::vector<Expr>& children,
+                                     ArrayView<Expr> children,
                                      Expr& hd,
                                      Expr& nil);
   /** The state */
   State& d_state;
+  /** The options */
+  Options& d_opts;
   /** Plugin of the state */
   Plugin * d_plugin;
   /** Mapping literal kinds to type rules */
@@ -123,6 +190,22 @@ class TypeChecker
   /** The null expression */
   Expr d_null;
   Expr d_negOne;
+  /**
+   * The storage of temporary terms, where the first d_numTemps are in use by
+   * the evaluation frames on the stack.
+   */
+  std::vector<std::unique_ptr<Literal>> d_temps;
+  /** The number of temporary terms in use */
+  size_t d_numTemps;
+  /** The pool of visited caches of evaluation frames */
+  std::vector<std::unique_ptr<EvalVisitedCache>> d_visitedPool;
+  //--------------------- scratch space for match
+  /** The pairs of subterms to match */
+  std::vector<std::pair<ExprValue*, ExprValue*>> d_matchStack;
+  /** The pairs visited, for non-linear patterns */
+  std::unordered_set<std::pair<ExprValue*, ExprValue*>,
+                     ExprValuePairHashFunction>
+      d_matchVisited;
 };
 
 }  // namespace ethos
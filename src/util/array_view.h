@@ -0,0 +1,55 @@
+/******************************************************************************
+ * This file is part of the ethos project.
+ *
+ * Copyright (c) 2023-2024 by the authors listed in the file AUTHORS
+ * in the top-level source directory and their institutional affiliations.
+ * All rights reserved.  See the file COPYING in the top-level source
+ * directory for licensing information.
+ ******************************************************************************/
+#ifndef UTIL__ARRAY_VIEW_H
+#define UTIL__ARRAY_VIEW_H
+
+#include <cstddef>
+#include <vector>
+
+namespace ethos {
+
+/**
+ * A non-owning, read-only view of a contiguous array of elements of type T.
+ * The array must outlive the view.
+ */
+template <typename T>
+class ArrayView
+{
+ public:
+  ArrayView() : d_data(nullptr), d_size(0) {}
+  ArrayView(const T* data, size_t size) : d_data(data), d_size(size) {}
+  ArrayView(const std::vector<T>& v) : d_data(v.data()), d_size(v.size()) {}
+  /** Iterators */
+  const T* begin() const { return d_data; }
+  const T* end() const { return d_data + d_size; }
+  /** Get the underlying data */
+  const T* data() const { return d_data; }
+  /** Get the number of elements */
+  size_t size() const { return d_size; }
+  /** Is this view empty? */
+  bool empty() const { return d_size == 0; }
+  /** Get the i-th element */
+  const T& operator[](size_t i) const { return d_data[i]; }
+  /** Get the first element */
+  const T& front() const { return d_data[0]; }
+  /** Get the last element */
+  const T& back() const { return d_data[d_size - 1]; }
+  /** Copy the elements to a vector */
+  std::vector<T> toVector() const { return std::vector<T>(begin(), end()); }
+
+ private:
+  /** Pointer to the first element */
+  const T* d_data;
+  /** The number of elements */
+  size_t d_size;
+};
+
+}  // namespace ethos
+
+#endif /* UTIL__ARRAY_VIEW_H */
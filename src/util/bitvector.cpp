@@ -12,30 +12,46 @@
 
 namespace ethos {
 
-BitVector::BitVector(const std::string& num, uint32_t base)
+BitVector::BitVector(const std::string& num, uint32_t base) : d_word(0)
 {
   Assert(base == 2 || base == 10 || base == 16);
   Assert(num[0] != '-');
-  d_value = Integer(num, base);
-  Assert(d_value.sgn()>=0);
+  Integer val(num, base);
+  Assert(val.sgn()>=0);
   // Compute the length, *without* any negative sign.
   switch (base)
   {
-    case 10: d_size = d_value.length(); break;
+    case 10: d_size = val.length(); break;
     case 16: d_size = num.size() * 4; break;
     default: d_size = num.size();
   }
+  setValue(val);
 }
 
-unsigned BitVector::getSize() const { return d_size; }
+void BitVector::setValue(const Integer& val)
+{
+  if (isWord())
+  {
+    d_word = val.modByPow2(d_size).toUnsigned64();
+    d_value = Integer();
+  }
+  else
+  {
+    d_word = 0;
+    d_value = val.modByPow2(d_size);
+  }
+}
 
-const Integer& BitVector::getValue() const { return d_value; }
+unsigned BitVector::getSize() const { return d_size; }
 
-Integer BitVector::toInteger() const { return d_value; }
+Integer BitVector::toInteger() const
+{
+  return isWord() ? Integer::fromUnsigned64(d_word) : d_value;
+}
 
 std::string BitVector::toString(unsigned int base) const
 {
-  std::string str = d_value.toString(base);
+  std::string str = toInteger().toString(base);
   if (base == 2 && d_size > str.size())
   {
     std::string zeroes;
@@ -55,7 +71,8 @@ std::string BitVector::toString(unsigned int base) const
 
 size_t BitVector::hash() const
 {
-  return std::hash<size_t>()(d_value.hash()) ^ std::hash<size_t>()(d_size);
+  size_t vh = isWord() ? static_cast<size_t>(d_word) : d_value.hash();
+  return std::hash<size_t>()(vh) ^ std::hash<size_t>()(d_size);
 }
 
 /* -----------------------------------------------------------------------
@@ -66,14 +83,29 @@ size_t BitVector::hash() const
 
 BitVector BitVector::concat(const BitVector& other) const
 {
-  return BitVector(d_size + other.d_size,
-                   (d_value.multiplyByPow2(other.d_size)) + other.d_value);
+  unsigned size = d_size + other.d_size;
+  if (size <= 64)
+  {
+    BitVector res(size);
+    // if other has width 64, then this has width 0
+    res.d_word = (other.d_size == 64 ? 0 : (d_word << other.d_size))
+                 | other.d_word;
+    return res;
+  }
+  return BitVector(
+      size, toInteger().multiplyByPow2(other.d_size) + other.toInteger());
 }
 
 BitVector BitVector::extract(unsigned high, unsigned low) const
 {
   Assert(high < d_size);
   Assert(low <= high);
+  if (isWord())
+  {
+    BitVector res(high - low + 1);
+    res.d_word = (d_word >> low) & mask(high - low + 1);
+    return res;
+  }
   return BitVector(high - low + 1,
                    d_value.extractBitRange(high - low + 1, low));
 }
@@ -83,7 +115,7 @@ BitVector BitVector::extract(unsigned high, unsigned low) const
 bool operator==(const BitVector& a, const BitVector& b)
 {
   if (a.getSize() != b.getSize()) return false;
-  return a.getValue() == b.getValue();
+  return a.d_word == b.d_word && a.d_value == b.d_value;
 }
 
 /* Bit-wise operations --------------------------------------------------- */
@@ -91,24 +123,48 @@ bool operator==(const BitVector& a, const BitVector& b)
 BitVector operator^(const BitVector& a, const BitVector& b)
 {
   Assert(a.getSize() == b.getSize());
-  return BitVector(a.getSize(), a.getValue().bitwiseXor(b.getValue()));
+  if (a.isWord())
+  {
+    BitVector res(a.d_size);
+    res.d_word = a.d_word ^ b.d_word;
+    return res;
+  }
+  return BitVector(a.getSize(), a.d_value.bitwiseXor(b.d_value));
 }
 
 BitVector operator|(const BitVector& a, const BitVector& b)
 {
   Assert(a.getSize() == b.getSize());
-  return BitVector(a.getSize(), a.getValue().bitwiseOr(b.getValue()));
+  if (a.isWord())
+  {
+    BitVector res(a.d_size);
+    res.d_word = a.d_word | b.d_word;
+    return res;
+  }
+  return BitVector(a.getSize(), a.d_value.bitwiseOr(b.d_value));
 }
 
 BitVector operator&(const BitVector& a, const BitVector& b)
 {
   Assert(a.getSize() == b.getSize());
-  return BitVector(a.getSize(), a.getValue().bitwiseAnd(b.getValue()));
+  if (a.isWord())
+  {
+    BitVector res(a.d_size);
+    res.d_word = a.d_word & b.d_word;
+    return res;
+  }
+  return BitVector(a.getSize(), a.d_value.bitwiseAnd(b.d_value));
 }
 
 BitVector operator~(const BitVector& a)
 {
-  return BitVector(a.getSize(), a.getValue().bitwiseNot());
+  if (a.isWord())
+  {
+    BitVector res(a.d_size);
+    res.d_word = ~a.d_word & BitVector::mask(a.d_size);
+    return res;
+  }
+  return BitVector(a.getSize(), a.d_value.bitwiseNot());
 }
 
 /* Arithmetic operations ------------------------------------------------- */
@@ -116,12 +172,24 @@ BitVector operator~(const BitVector& a)
 BitVector operator+(const BitVector& a, const BitVector& b)
 {
   Assert(a.getSize() == b.getSize());
-  Integer sum = a.getValue() + b.getValue();
+  if (a.isWord())
+  {
+    BitVector res(a.d_size);
+    res.d_word = (a.d_word + b.d_word) & BitVector::mask(a.d_size);
+    return res;
+  }
+  Integer sum = a.d_value + b.d_value;
   return BitVector(a.getSize(), sum);
 }
 
 BitVector operator-(const BitVector& a)
 {
+  if (a.isWord())
+  {
+    BitVector res(a.d_size);
+    res.d_word = (~a.d_word + 1) & BitVector::mask(a.d_size);
+    return res;
+  }
   BitVector one(a.getSize(), Integer(1));
   return ~a + one;
 }
@@ -129,13 +197,26 @@ BitVector operator-(const BitVector& a)
 BitVector operator*(const BitVector& a, const BitVector& b)
 {
   Assert(a.getSize() == b.getSize());
-  Integer prod = a.getValue() * b.getValue();
+  if (a.isWord())
+  {
+    BitVector res(a.d_size);
+    res.d_word = (a.d_word * b.d_word) & BitVector::mask(a.d_size);
+    return res;
+  }
+  Integer prod = a.d_value * b.d_value;
   return BitVector(a.getSize(), prod);
 }
 
 BitVector BitVector::unsignedDivTotal(const BitVector& y) const
 {
   Assert(d_size == y.d_size);
+  if (isWord())
+  {
+    /* d_word / 0 = -1 = 2^d_size - 1 */
+    BitVector res(d_size);
+    res.d_word = y.d_word == 0 ? mask(d_size) : d_word / y.d_word;
+    return res;
+  }
   /* d_value / 0 = -1 = 2^d_size - 1 */
   if (y.d_value.sgn()==0)
   {
@@ -149,6 +230,12 @@ BitVector BitVector::unsignedDivTotal(const BitVector& y) const
 BitVector BitVector::unsignedRemTotal(const BitVector& y) const
 {
   Assert(d_size == y.d_size);
+  if (isWord())
+  {
+    BitVector res(d_size);
+    res.d_word = y.d_word == 0 ? d_word : d_word % y.d_word;
+    return res;
+  }
   if (y.d_value.sgn()==0)
   {
     return BitVector(d_size, d_value);
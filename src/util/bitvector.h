@@ -17,15 +17,31 @@
 
 namespace ethos {
 
+/**
+ * A fixed-width bit-vector constant.
+ *
+ * Bit-vectors of width at most 64 are stored in a machine word, on which all
+ * operations are computed directly. Wider bit-vectors are stored as an
+ * Integer.
+ */
 class BitVector
 {
+  friend bool operator==(const BitVector& a, const BitVector& b);
+  friend BitVector operator^(const BitVector& a, const BitVector& b);
+  friend BitVector operator|(const BitVector& a, const BitVector& b);
+  friend BitVector operator&(const BitVector& a, const BitVector& b);
+  friend BitVector operator~(const BitVector& a);
+  friend BitVector operator+(const BitVector& a, const BitVector& b);
+  friend BitVector operator-(const BitVector& a);
+  friend BitVector operator*(const BitVector& a, const BitVector& b);
+
  public:
-  BitVector(unsigned size, const Integer& val)
-      : d_size(size), d_value(val.modByPow2(size))
+  BitVector(unsigned size, const Integer& val) : d_size(size), d_word(0)
   {
+    setValue(val);
   }
 
-  BitVector(unsigned size = 0) : d_size(size), d_value(0) {}
+  BitVector(unsigned size = 0) : d_size(size), d_word(0), d_value(0) {}
 
   /**
    * BitVector constructor using a 32-bit unsigned integer for the value.
@@ -34,9 +50,11 @@ class BitVector
    * platforms (long is 32-bit when compiling 64-bit binaries on
    * Windows but 64-bit on Linux) and to prevent ambiguous overloads.
    */
-  BitVector(unsigned size, uint32_t z) : d_size(size), d_value(z)
+  BitVector(unsigned size, uint32_t z)
+      : d_size(size),
+        d_word(isWord() ? z & mask(size) : 0),
+        d_value(isWord() ? 0 : z)
   {
-    d_value = d_value.modByPow2(size);
   }
 
   /**
@@ -46,14 +64,14 @@ class BitVector
    * platforms (long is 32-bit when compiling 64-bit binaries on
    * Windows but 64-bit on Linux) and to prevent ambiguous overloads.
    */
-  BitVector(unsigned size, uint64_t z) : d_size(size), d_value(z)
+  BitVector(unsigned size, uint64_t z) : d_size(size), d_word(0)
   {
-    d_value = d_value.modByPow2(size);
+    setValue(Integer::fromUnsigned64(z));
   }
 
-  BitVector(unsigned size, const BitVector& q)
-      : d_size(size), d_value(q.d_value)
+  BitVector(unsigned size, const BitVector& q) : d_size(size), d_word(0)
   {
+    setValue(q.toInteger());
   }
 
   /**
@@ -78,14 +96,13 @@ class BitVector
   {
     if (this == &x) return *this;
     d_size = x.d_size;
+    d_word = x.d_word;
     d_value = x.d_value;
     return *this;
   }
 
   /* Get size (bit-width). */
   unsigned getSize() const;
-  /* Get value. */
-  const Integer& getValue() const;
 
   /* Return value. */
   Integer toInteger() const;
@@ -120,13 +137,26 @@ class BitVector
   BitVector unsignedRemTotal(const BitVector& y) const;
 
  private:
+  /* Return true if the value is stored in d_word. */
+  bool isWord() const { return d_size <= 64; }
+  /* Return the mask of the low 'size' bits of a word, for size <= 64. */
+  static uint64_t mask(unsigned size)
+  {
+    return size == 0 ? 0 : (~uint64_t(0) >> (64 - size));
+  }
+  /* Set the value of this bit-vector to val mod 2^d_size. */
+  void setValue(const Integer& val);
+
   /**
    * Class invariants:
    *  - no overflows: 2^d_size < d_value
    *  - no negative numbers: d_value >= 0
+   *  - the value is stored in d_word if d_size <= 64, where d_value is 0,
+   *    and in d_value otherwise, where d_word is 0.
    */
 
   unsigned d_size;
+  uint64_t d_word;
   Integer d_value;
 
 }; /* class BitVector */
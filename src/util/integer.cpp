@@ -6,8 +6,10 @@
  * All rights reserved.  See the file COPYING in the top-level source
  * directory for licensing information.
  ******************************************************************************/
+#include <charconv>
 #include <cmath>
 #include <limits>
+#include <numeric>
 #include <sstream>
 #include <string>
 
@@ -17,70 +19,240 @@ using namespace std;
 
 namespace ethos {
 
-Integer::Integer(const std::string& s, unsigned base)
-  : d_value(s, base)
-{}
+namespace {
+
+/** The bound on the absolute value of an Integer stored inline */
+constexpr int64_t s_maxSmall = std::numeric_limits<int64_t>::max();
+
+/** The absolute value of v, which is stored inline */
+uint64_t absSmall(int64_t v)
+{
+  return v < 0 ? static_cast<uint64_t>(-v) : static_cast<uint64_t>(v);
+}
+
+}  // namespace
+
+Integer::Integer(const mpz_class& val) : d_small(0) { setMpz(val); }
+
+Integer::Integer(const std::string& s, unsigned base) : d_small(0)
+{
+  int64_t v;
+  const char* end = s.data() + s.size();
+  std::from_chars_result res = std::from_chars(s.data(), end, v, base);
+  if (res.ec == std::errc() && res.ptr == end && v >= -s_maxSmall)
+  {
+    d_small = v;
+    return;
+  }
+  setMpz(mpz_class(s, base));
+}
+
+Integer::Integer(const Integer& q) : d_small(q.d_small)
+{
+  if (!q.isSmall())
+  {
+    d_big.reset(new mpz_class(*q.d_big));
+  }
+}
+
+Integer Integer::fromInt64(int64_t v)
+{
+  Integer res;
+  if (v >= -s_maxSmall)
+  {
+    res.d_small = v;
+  }
+  else
+  {
+    // the minimum value of int64_t does not fit inline
+    res.d_big.reset(new mpz_class(-s_maxSmall));
+    *res.d_big -= 1;
+  }
+  return res;
+}
+
+Integer Integer::fromUnsigned64(uint64_t z)
+{
+  if (z <= static_cast<uint64_t>(s_maxSmall))
+  {
+    return fromInt64(static_cast<int64_t>(z));
+  }
+  mpz_class res;
+  mpz_import(res.get_mpz_t(), 1, -1, sizeof(z), 0, 0, &z);
+  return Integer(res);
+}
+
+void Integer::setMpz(const mpz_class& z)
+{
+  if (mpz_sizeinbase(z.get_mpz_t(), 2) <= 63)
+  {
+    uint64_t mag = 0;
+    mpz_export(&mag, nullptr, -1, sizeof(mag), 0, 0, z.get_mpz_t());
+    int64_t v = static_cast<int64_t>(mag);
+    d_small = mpz_sgn(z.get_mpz_t()) < 0 ? -v : v;
+    d_big.reset();
+  }
+  else if (isSmall())
+  {
+    d_big.reset(new mpz_class(z));
+  }
+  else
+  {
+    *d_big = z;
+  }
+}
+
+const mpz_class& Integer::getMpz(mpz_class& tmp) const
+{
+  if (!isSmall())
+  {
+    return *d_big;
+  }
+  uint64_t mag = absSmall(d_small);
+  mpz_import(tmp.get_mpz_t(), 1, -1, sizeof(mag), 0, 0, &mag);
+  if (d_small < 0)
+  {
+    mpz_neg(tmp.get_mpz_t(), tmp.get_mpz_t());
+  }
+  return tmp;
+}
+
+int Integer::compare(const Integer& x, const Integer& y)
+{
+  if (x.isSmall() && y.isSmall())
+  {
+    return x.d_small < y.d_small ? -1 : (x.d_small == y.d_small ? 0 : 1);
+  }
+  // a value stored in GMP is larger in magnitude than one stored inline
+  if (y.isSmall())
+  {
+    return x.sgn();
+  }
+  if (x.isSmall())
+  {
+    return -y.sgn();
+  }
+  int c = mpz_cmp(x.d_big->get_mpz_t(), y.d_big->get_mpz_t());
+  return c < 0 ? -1 : (c == 0 ? 0 : 1);
+}
 
 Integer& Integer::operator=(const Integer& x)
 {
   if (this == &x) return *this;
-  d_value = x.d_value;
+  if (x.isSmall())
+  {
+    d_small = x.d_small;
+    d_big.reset();
+  }
+  else
+  {
+    setMpz(*x.d_big);
+  }
   return *this;
 }
 
 bool Integer::operator==(const Integer& y) const
 {
-  return d_value == y.d_value;
+  return compare(*this, y) == 0;
 }
 
-bool Integer::operator>(const Integer& y) const { return d_value > y.d_value; }
+bool Integer::operator>(const Integer& y) const { return compare(*this, y) > 0; }
 
-bool Integer::operator>=(const Integer& y) const { return d_value >= y.d_value; }
+bool Integer::operator>=(const Integer& y) const { return compare(*this, y) >= 0; }
 
-Integer Integer::operator-() const { return Integer(-(d_value)); }
+Integer Integer::operator-() const
+{
+  if (isSmall())
+  {
+    return fromInt64(-d_small);
+  }
+  return Integer(-(*d_big));
+}
 
 Integer Integer::operator+(const Integer& y) const
 {
-  return Integer(d_value + y.d_value);
+  int64_t res;
+  if (isSmall() && y.isSmall()
+      && !__builtin_add_overflow(d_small, y.d_small, &res))
+  {
+    return fromInt64(res);
+  }
+  mpz_class tx, ty;
+  return Integer(getMpz(tx) + y.getMpz(ty));
 }
 
 Integer Integer::operator*(const Integer& y) const
 {
-  return Integer(d_value * y.d_value);
+  int64_t res;
+  if (isSmall() && y.isSmall()
+      && !__builtin_mul_overflow(d_small, y.d_small, &res))
+  {
+    return fromInt64(res);
+  }
+  mpz_class tx, ty;
+  return Integer(getMpz(tx) * y.getMpz(ty));
 }
 
 Integer Integer::bitwiseOr(const Integer& y) const
 {
-  mpz_class result;
-  mpz_ior(result.get_mpz_t(), d_value.get_mpz_t(), y.d_value.get_mpz_t());
+  if (isSmall() && y.isSmall())
+  {
+    return fromInt64(d_small | y.d_small);
+  }
+  mpz_class result, tx, ty;
+  mpz_ior(result.get_mpz_t(),
+          getMpz(tx).get_mpz_t(),
+          y.getMpz(ty).get_mpz_t());
   return Integer(result);
 }
 
 Integer Integer::bitwiseAnd(const Integer& y) const
 {
-  mpz_class result;
-  mpz_and(result.get_mpz_t(), d_value.get_mpz_t(), y.d_value.get_mpz_t());
+  if (isSmall() && y.isSmall())
+  {
+    return fromInt64(d_small & y.d_small);
+  }
+  mpz_class result, tx, ty;
+  mpz_and(result.get_mpz_t(),
+          getMpz(tx).get_mpz_t(),
+          y.getMpz(ty).get_mpz_t());
   return Integer(result);
 }
 
 Integer Integer::bitwiseXor(const Integer& y) const
 {
-  mpz_class result;
-  mpz_xor(result.get_mpz_t(), d_value.get_mpz_t(), y.d_value.get_mpz_t());
+  if (isSmall() && y.isSmall())
+  {
+    return fromInt64(d_small ^ y.d_small);
+  }
+  mpz_class result, tx, ty;
+  mpz_xor(result.get_mpz_t(),
+          getMpz(tx).get_mpz_t(),
+          y.getMpz(ty).get_mpz_t());
   return Integer(result);
 }
 
 Integer Integer::bitwiseNot() const
 {
+  if (isSmall())
+  {
+    return fromInt64(~d_small);
+  }
   mpz_class result;
-  mpz_com(result.get_mpz_t(), d_value.get_mpz_t());
+  mpz_com(result.get_mpz_t(), d_big->get_mpz_t());
   return Integer(result);
 }
 
 Integer Integer::multiplyByPow2(uint32_t pow) const
 {
-  mpz_class result;
-  mpz_mul_2exp(result.get_mpz_t(), d_value.get_mpz_t(), pow);
+  int64_t res;
+  if (isSmall() && pow < 63
+      && !__builtin_mul_overflow(d_small, int64_t(1) << pow, &res))
+  {
+    return fromInt64(res);
+  }
+  mpz_class result, tx;
+  mpz_mul_2exp(result.get_mpz_t(), getMpz(tx).get_mpz_t(), pow);
   return Integer(result);
 }
 
@@ -88,7 +260,13 @@ Integer Integer::oneExtend(uint32_t size, uint32_t amount) const
 {
   // check that the size is accurate
   //Assert((*this) < Integer(1).multiplyByPow2(size));
-  mpz_class res = d_value;
+  if (isSmall() && d_small >= 0 && size + amount < 63)
+  {
+    int64_t ones = ((int64_t(1) << amount) - 1) << size;
+    return fromInt64(d_small | ones);
+  }
+  mpz_class tx;
+  mpz_class res = getMpz(tx);
 
   for (unsigned i = size; i < size + amount; ++i)
   {
@@ -98,20 +276,48 @@ Integer Integer::oneExtend(uint32_t size, uint32_t amount) const
   return Integer(res);
 }
 
-bool Integer::fitsUnsignedInt() const { return d_value.fits_uint_p(); }
+bool Integer::fitsUnsignedInt() const
+{
+  if (isSmall())
+  {
+    return d_small >= 0 && d_small <= std::numeric_limits<unsigned int>::max();
+  }
+  return false;
+}
 
 uint32_t Integer::toUnsignedInt() const
 {
-  return mpz_get_ui(d_value.get_mpz_t());
+  if (isSmall())
+  {
+    return static_cast<uint32_t>(absSmall(d_small));
+  }
+  return mpz_get_ui(d_big->get_mpz_t());
+}
+
+uint64_t Integer::toUnsigned64() const
+{
+  if (isSmall())
+  {
+    return static_cast<uint64_t>(d_small);
+  }
+  uint64_t res = 0;
+  mpz_export(&res, nullptr, -1, sizeof(res), 0, 0, d_big->get_mpz_t());
+  return res;
 }
 
 Integer Integer::extractBitRange(uint32_t bitCount, uint32_t low) const
 {
   // bitCount = high-low+1
   uint32_t high = low + bitCount - 1;
+  if (isSmall() && high < 62)
+  {
+    // two's complement, as for the floor remainder below
+    int64_t rem = d_small & ((int64_t(1) << (high + 1)) - 1);
+    return fromInt64(rem >> low);
+  }
   //- Function: void mpz_fdiv_r_2exp (mpz_t r, mpz_t n, mp_bitcnt_t b)
-  mpz_class rem, div;
-  mpz_fdiv_r_2exp(rem.get_mpz_t(), d_value.get_mpz_t(), high + 1);
+  mpz_class rem, div, tx;
+  mpz_fdiv_r_2exp(rem.get_mpz_t(), getMpz(tx).get_mpz_t(), high + 1);
   mpz_fdiv_q_2exp(div.get_mpz_t(), rem.get_mpz_t(), low);
 
   return Integer(div);
@@ -119,15 +325,29 @@ Integer Integer::extractBitRange(uint32_t bitCount, uint32_t low) const
 
 Integer Integer::floorDivideQuotient(const Integer& y) const
 {
-  mpz_class q;
-  mpz_fdiv_q(q.get_mpz_t(), d_value.get_mpz_t(), y.d_value.get_mpz_t());
+  if (isSmall() && y.isSmall() && y.d_small != 0)
+  {
+    int64_t q = d_small / y.d_small;
+    int64_t r = d_small % y.d_small;
+    return fromInt64((r != 0 && (r < 0) != (y.d_small < 0)) ? q - 1
+                                                                     : q);
+  }
+  mpz_class q, tx, ty;
+  mpz_fdiv_q(q.get_mpz_t(), getMpz(tx).get_mpz_t(), y.getMpz(ty).get_mpz_t());
   return Integer(q);
 }
 
 Integer Integer::floorDivideRemainder(const Integer& y) const
 {
-  mpz_class r;
-  mpz_fdiv_r(r.get_mpz_t(), d_value.get_mpz_t(), y.d_value.get_mpz_t());
+  if (isSmall() && y.isSmall() && y.d_small != 0)
+  {
+    int64_t r = d_small % y.d_small;
+    return fromInt64((r != 0 && (r < 0) != (y.d_small < 0))
+                                  ? r + y.d_small
+                                  : r);
+  }
+  mpz_class r, tx, ty;
+  mpz_fdiv_r(r.get_mpz_t(), getMpz(tx).get_mpz_t(), y.getMpz(ty).get_mpz_t());
   return Integer(r);
 }
 
@@ -137,10 +357,8 @@ void Integer::euclidianQR(Integer& q,
                           const Integer& y)
 {
   // compute the floor and then fix the value up if needed.
-  mpz_fdiv_qr(q.d_value.get_mpz_t(),
-              r.d_value.get_mpz_t(),
-              x.d_value.get_mpz_t(),
-              y.d_value.get_mpz_t());
+  q = x.floorDivideQuotient(y);
+  r = x.floorDivideRemainder(y);
 
   if (r.sgn()<0)
   {
@@ -184,26 +402,91 @@ Integer Integer::euclidianDivideRemainder(const Integer& y) const
 
 Integer Integer::modByPow2(uint32_t exp) const
 {
-  mpz_class res;
-  mpz_fdiv_r_2exp(res.get_mpz_t(), d_value.get_mpz_t(), exp);
+  if (isSmall() && (exp < 63 || d_small >= 0))
+  {
+    return exp < 63 ? fromInt64(d_small & ((int64_t(1) << exp) - 1))
+                    : *this;
+  }
+  mpz_class res, tx;
+  mpz_fdiv_r_2exp(res.get_mpz_t(), getMpz(tx).get_mpz_t(), exp);
   return Integer(res);
 }
 
-int Integer::sgn() const { return mpz_sgn(d_value.get_mpz_t()); }
+int Integer::sgn() const
+{
+  if (isSmall())
+  {
+    return d_small < 0 ? -1 : (d_small == 0 ? 0 : 1);
+  }
+  return mpz_sgn(d_big->get_mpz_t());
+}
 
 Integer Integer::pow(uint32_t exp) const
 {
-  mpz_class result;
-  mpz_pow_ui(result.get_mpz_t(), d_value.get_mpz_t(), exp);
+  if (isSmall())
+  {
+    int64_t res = 1;
+    uint32_t i = 0;
+    while (i < exp && !__builtin_mul_overflow(res, d_small, &res))
+    {
+      i++;
+    }
+    if (i == exp)
+    {
+      return fromInt64(res);
+    }
+  }
+  mpz_class result, tx;
+  mpz_pow_ui(result.get_mpz_t(), getMpz(tx).get_mpz_t(), exp);
+  return Integer(result);
+}
+
+Integer Integer::gcd(const Integer& y) const
+{
+  if (isSmall() && y.isSmall())
+  {
+    return fromInt64(
+        static_cast<int64_t>(std::gcd(absSmall(d_small), absSmall(y.d_small))));
+  }
+  mpz_class result, tx, ty;
+  mpz_gcd(result.get_mpz_t(), getMpz(tx).get_mpz_t(), y.getMpz(ty).get_mpz_t());
   return Integer(result);
 }
 
-std::string Integer::toString(int base) const { return d_value.get_str(base); }
+Integer Integer::exactQuotient(const Integer& y) const
+{
+  if (isSmall() && y.isSmall())
+  {
+    return fromInt64(d_small / y.d_small);
+  }
+  mpz_class result, tx, ty;
+  mpz_divexact(
+      result.get_mpz_t(), getMpz(tx).get_mpz_t(), y.getMpz(ty).get_mpz_t());
+  return Integer(result);
+}
+
+std::string Integer::toString(int base) const
+{
+  if (isSmall() && base >= 2 && base <= 36)
+  {
+    char buf[72];
+    std::to_chars_result res =
+        std::to_chars(buf, buf + sizeof(buf), d_small, base);
+    return std::string(buf, res.ptr);
+  }
+  mpz_class tx;
+  return getMpz(tx).get_str(base);
+}
 
 
 size_t Integer::hash() const
 {
-  return gmpHash(d_value.get_mpz_t());
+  if (isSmall())
+  {
+    // the same as the hash of its single GMP limb
+    return static_cast<size_t>(absSmall(d_small));
+  }
+  return gmpHash(d_big->get_mpz_t());
 }
 
 size_t Integer::gmpHash(const mpz_t toHash)
@@ -223,9 +506,13 @@ size_t Integer::length() const
   {
     return 1;
   }
+  else if (isSmall())
+  {
+    return 64 - __builtin_clzll(absSmall(d_small));
+  }
   else
   {
-    return mpz_sizeinbase(d_value.get_mpz_t(), 2);
+    return mpz_sizeinbase(d_big->get_mpz_t(), 2);
   }
 }
 
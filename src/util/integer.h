@@ -12,6 +12,7 @@
 #include <gmpxx.h>
 
 #include <iosfwd>
+#include <memory>
 #include <string>
 #include <cstdint>
 
@@ -19,6 +20,15 @@ namespace ethos {
 
 class Rational;
 
+/**
+ * An arbitrary precision integer.
+ *
+ * Values whose absolute value fits in 63 bits are stored inline, and all
+ * operations on them use checked machine arithmetic. A GMP integer is
+ * allocated only for values that do not fit, including the results of
+ * operations that overflow. The representation is canonical, i.e. a value
+ * is stored in GMP if and only if it does not fit inline.
+ */
 class Integer
 {
   friend class Rational;
@@ -27,10 +37,10 @@ class Integer
   /**
    * Constructs an Integer by copying a GMP C++ primitive.
    */
-  Integer(const mpz_class& val) : d_value(val) {}
+  Integer(const mpz_class& val);
 
   /** Constructs a rational with the value 0. */
-  Integer() : d_value(0) {}
+  Integer() : d_small(0) {}
 
   /**
    * Constructs a Integer from a C string.
@@ -40,15 +50,14 @@ class Integer
    */
   explicit Integer(const std::string& s, unsigned base = 10);
 
-  explicit Integer(unsigned int z) : d_value(z) {}
-  Integer(const Integer& q) : d_value(q.d_value) {}
+  explicit Integer(unsigned int z) : d_small(z) {}
+  /** Returns the Integer with the value of a 64 bit unsigned integer. */
+  static Integer fromUnsigned64(uint64_t z);
+  Integer(const Integer& q);
 
   /** Destructor. */
   ~Integer() {}
 
-  /** Returns a copy of d_value to enable public access of GMP data. */
-  const mpz_class& getValue() const { return d_value; }
-
   /** Overload copy assignment operator. */
   Integer& operator=(const Integer& x);
 
@@ -88,6 +97,11 @@ class Integer
   bool fitsUnsignedInt() const;
   /** Return a 32 bit unsigned integer representation of this Integer. */
   uint32_t toUnsignedInt() const;
+  /**
+   * Return a 64 bit unsigned integer representation of this Integer, which
+   * must be non-negative and less than 2^64.
+   */
+  uint64_t toUnsigned64() const;
 
   /**
    * Extract a range of bits from index 'low' to (excluding) 'low + bitCount'.
@@ -136,6 +150,12 @@ class Integer
   /** Raise this Integer to the power 'exp'. */
   Integer pow(uint32_t exp) const;
 
+  /** Return the greatest common divisor of this Integer and y. */
+  Integer gcd(const Integer& y) const;
+
+  /** Return this / y, where y divides this. */
+  Integer exactQuotient(const Integer& y) const;
+
   /** Return a string representation of this Integer. */
   std::string toString(int base = 10) const;
 
@@ -155,17 +175,27 @@ class Integer
   size_t length() const;
 
  private:
+  /** Returns the Integer with value v, which may not fit inline. */
+  static Integer fromInt64(int64_t v);
+  /** Returns -1, 0, 1 if x is less than, equal to or greater than y. */
+  static int compare(const Integer& x, const Integer& y);
+  /** Set the value of this Integer to z. */
+  void setMpz(const mpz_class& z);
   /**
-   * Gets a reference to the gmp data that backs up the integer.
-   * Only accessible to friend classes.
+   * Get the GMP value of this Integer, which is stored in tmp if this Integer
+   * is stored inline.
    */
-  const mpz_class& get_mpz() const { return d_value; }
+  const mpz_class& getMpz(mpz_class& tmp) const;
+  /** Is the value stored inline? */
+  bool isSmall() const { return d_big == nullptr; }
 
+  /** The value, if it is stored inline */
+  int64_t d_small;
   /**
-   * The value of the rational is stored in a C++ GMP integer class.
-   * Using this instead of mpz_t allows for easier destruction.
+   * The value, if it does not fit inline. This is a C++ GMP integer, which
+   * allows for easier destruction than mpz_t.
    */
-  mpz_class d_value;
+  std::unique_ptr<mpz_class> d_big;
 }; /* class Integer */
 
 
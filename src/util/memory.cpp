@@ -0,0 +1,37 @@
+/******************************************************************************
+ * This file is part of the ethos project.
+ *
+ * Copyright (c) 2023-2024 by the authors listed in the file AUTHORS
+ * in the top-level source directory and their institutional affiliations.
+ * All rights reserved.  See the file COPYING in the top-level source
+ * directory for licensing information.
+ ******************************************************************************/
+#include "util/memory.h"
+
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif
+
+namespace ethos {
+
+size_t getPeakResidentMemory()
+{
+#ifndef _WIN32
+  struct rusage ru;
+  if (getrusage(RUSAGE_SELF, &ru) != 0)
+  {
+    return 0;
+  }
+#ifdef __APPLE__
+  // reported in bytes
+  return static_cast<size_t>(ru.ru_maxrss);
+#else
+  // reported in kilobytes
+  return static_cast<size_t>(ru.ru_maxrss) * 1024;
+#endif
+#else
+  return 0;
+#endif
+}
+
+}  // namespace ethos
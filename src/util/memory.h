@@ -0,0 +1,24 @@
+/******************************************************************************
+ * This file is part of the ethos project.
+ *
+ * Copyright (c) 2023-2024 by the authors listed in the file AUTHORS
+ * in the top-level source directory and their institutional affiliations.
+ * All rights reserved.  See the file COPYING in the top-level source
+ * directory for licensing information.
+ ******************************************************************************/
+#ifndef UTIL__MEMORY_H
+#define UTIL__MEMORY_H
+
+#include <cstddef>
+
+namespace ethos {
+
+/**
+ * Get the peak resident set size of this process in bytes, or 0 if it cannot
+ * be determined on this platform.
+ */
+size_t getPeakResidentMemory();
+
+}  // namespace ethos
+
+#endif /* UTIL__MEMORY_H */
@@ -42,9 +42,69 @@ Rational Rational::fromDecimal(const std::string& dec) {
   }
 }
 
-bool Rational::isIntegral() const { return mpz_cmp_ui(d_value.get_den_mpz_t(), 1) == 0; }
+Rational::Rational(const std::string& s, unsigned base)
+{
+  std::string::size_type i = s.find('/');
+  if (i == std::string::npos)
+  {
+    d_num = Integer(s, base);
+    d_den = Integer(1);
+    return;
+  }
+  d_num = Integer(s.substr(0, i), base);
+  d_den = Integer(s.substr(i + 1), base);
+  canonicalize();
+}
+
+void Rational::canonicalize()
+{
+  if (d_den.sgn() < 0)
+  {
+    d_num = -d_num;
+    d_den = -d_den;
+  }
+  Integer g = d_num.gcd(d_den);
+  if (!(g == Integer(1)))
+  {
+    d_num = d_num.exactQuotient(g);
+    d_den = d_den.exactQuotient(g);
+  }
+}
+
+Rational Rational::operator+(const Rational& y) const
+{
+  if (d_den == y.d_den)
+  {
+    // common for integral values, which need no canonicalization
+    if (d_den == Integer(1))
+    {
+      return Rational(d_num + y.d_num, d_den, true);
+    }
+    return Rational(d_num + y.d_num, d_den);
+  }
+  return Rational(d_num * y.d_den + y.d_num * d_den, d_den * y.d_den);
+}
+
+Rational Rational::operator*(const Rational& y) const
+{
+  return Rational(d_num * y.d_num, d_den * y.d_den);
+}
 
-std::string Rational::toString(int base) const { return d_value.get_str(base); }
+Rational Rational::operator/(const Rational& y) const
+{
+  return Rational(d_num * y.d_den, d_den * y.d_num);
+}
+
+bool Rational::isIntegral() const { return d_den == Integer(1); }
+
+std::string Rational::toString(int base) const
+{
+  if (isIntegral())
+  {
+    return d_num.toString(base);
+  }
+  return d_num.toString(base) + "/" + d_den.toString(base);
+}
 std::string Rational::toStringDecimal() const
 {
   // NOTE: we simply print as a rational for now, due to limitations in
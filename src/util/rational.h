@@ -9,7 +9,7 @@
 #ifndef RATIONAL_H
 #define RATIONAL_H
 
-#include <gmp.h>
+#include <gmpxx.h>
 
 #include <optional>
 #include <string>
@@ -36,7 +36,10 @@ class Rational
    * Assumes that the value is in canonical form, and thus does not
    * have to call canonicalize() on the value.
    */
-  Rational(const mpq_class& val) : d_value(val) {}
+  Rational(const mpq_class& val)
+      : d_num(val.get_num()), d_den(val.get_den())
+  {
+  }
 
   /**
    * Creates a rational from a decimal string (e.g., <code>"1.5"</code>).
@@ -47,62 +50,49 @@ class Rational
   static Rational fromDecimal(const std::string& dec);
 
   /** Constructs a rational with the value 0/1. */
-  Rational() : d_value(0) { d_value.canonicalize(); }
+  Rational() : d_num(0), d_den(1) {}
 
-  Rational(const std::string& s, unsigned base = 10) : d_value(s, base)
-  {
-    d_value.canonicalize();
-  }
+  Rational(const std::string& s, unsigned base = 10);
 
   /**
    * Creates a Rational from another Rational, q, by performing a deep copy.
    */
-  Rational(const Rational& q) : d_value(q.d_value) { d_value.canonicalize(); }
+  Rational(const Rational& q) : d_num(q.d_num), d_den(q.d_den) {}
 
-  Rational(const Integer& n, const Integer& d)
-      : d_value(n.get_mpz(), d.get_mpz())
+  Rational(const Integer& n, const Integer& d) : d_num(n), d_den(d)
   {
-    d_value.canonicalize();
+    canonicalize();
   }
-  Rational(const Integer& n) : d_value(n.get_mpz()) { d_value.canonicalize(); }
+  Rational(const Integer& n) : d_num(n), d_den(1) {}
   ~Rational() {}
 
-  int sgn() const { return mpq_sgn(d_value.get_mpq_t()); }
+  int sgn() const { return d_num.sgn(); }
 
-  Integer floor() const
-  {
-    mpz_class q;
-    mpz_fdiv_q(q.get_mpz_t(), d_value.get_num_mpz_t(), d_value.get_den_mpz_t());
-    return Integer(q);
-  }
+  Integer floor() const { return d_num.floorDivideQuotient(d_den); }
 
   Rational& operator=(const Rational& x)
   {
     if (this == &x) return *this;
-    d_value = x.d_value;
+    d_num = x.d_num;
+    d_den = x.d_den;
     return *this;
   }
 
-  Rational operator-() const { return Rational(-(d_value)); }
+  Rational operator-() const { return Rational(-d_num, d_den, true); }
 
-  bool operator==(const Rational& y) const { return d_value == y.d_value; }
-
-  Rational operator+(const Rational& y) const
+  bool operator==(const Rational& y) const
   {
-    return Rational(d_value + y.d_value);
+    return d_num == y.d_num && d_den == y.d_den;
   }
 
-  Rational operator*(const Rational& y) const
-  {
-    return Rational(d_value * y.d_value);
-  }
-  Rational operator/(const Rational& y) const
-  {
-    return Rational(d_value / y.d_value);
-  }
+  Rational operator+(const Rational& y) const;
+
+  Rational operator*(const Rational& y) const;
+  Rational operator/(const Rational& y) const;
   bool operator>(const Rational& y) const
   {
-    return d_value > y.d_value;
+    // the denominators are positive
+    return d_num * y.d_den > y.d_num * d_den;
   }
 
   bool isIntegral() const;
@@ -119,16 +109,27 @@ class Rational
    */
   size_t hash() const
   {
-    size_t numeratorHash = Integer::gmpHash(d_value.get_num_mpz_t());
-    size_t denominatorHash = Integer::gmpHash(d_value.get_den_mpz_t());
+    size_t numeratorHash = d_num.hash();
+    size_t denominatorHash = d_den.hash();
     return numeratorHash ^ denominatorHash;
   }
  private:
+  /** Constructs the rational n/d, which is already in canonical form. */
+  Rational(const Integer& n, const Integer& d, bool isCanonical)
+      : d_num(n), d_den(d)
+  {
+  }
+  /**
+   * Put this rational in canonical form, where the denominator is positive
+   * and the gcd of the numerator and denominator is 1.
+   */
+  void canonicalize();
   /**
-   * Stores the value of the rational is stored in a C++ GMP rational class.
-   * Using this instead of mpq_t allows for easier destruction.
+   * The numerator and denominator. Both are stored inline if they fit, and
+   * in GMP otherwise.
    */
-  mpq_class d_value;
+  Integer d_num;
+  Integer d_den;
 
 }; /* class Rational */
 
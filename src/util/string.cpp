@@ -10,10 +10,13 @@
 #include "util/string.h"
 
 #include <algorithm>
+#include <functional>
 #include <limits>
 #include <iomanip>
 #include <iostream>
 #include <sstream>
+#include <string_view>
+#include <type_traits>
 
 #include "base/check.h"
 
@@ -21,35 +24,161 @@ namespace ethos {
 
 //static_assert(std::UCHAR_MAX == 255, "Unsigned char is assumed to have 256 values.");
 
-String::String(const std::vector<unsigned> &s) : d_str(s)
+namespace {
+
+/**
+ * Return the first position of the code points [n, n+nsize) in
+ * [h, h+hsize), or std::string::npos otherwise.
+ */
+template <typename H, typename N>
+std::size_t findIn(const H* h, std::size_t hsize, const N* n, std::size_t nsize)
+{
+  const H* hend = h + hsize;
+  const H* itr;
+  if constexpr (std::is_same_v<H, N>)
+  {
+    itr = std::search(
+        h, hend, std::boyer_moore_horspool_searcher(n, n + nsize));
+  }
+  else
+  {
+    itr = std::search(h, hend, n, n + nsize, std::equal_to<>());
+  }
+  return itr == hend ? std::string::npos : static_cast<std::size_t>(itr - h);
+}
+
+/** The code points of a byte buffer */
+const unsigned char* getCodePoints(const std::string& s)
+{
+  return reinterpret_cast<const unsigned char*>(s.data());
+}
+
+}  // namespace
+
+String::String(const std::vector<unsigned> &s) : d_size(s.size())
 {
 #ifdef EO_ASSERTIONS
-  for (unsigned u : d_str)
+  for (unsigned u : s)
   {
     Assert(u < num_codes());
   }
 #endif
+  if (s.empty())
+  {
+    return;
+  }
+  bool isWide = std::any_of(s.begin(), s.end(), [](unsigned u) {
+    return u > 255;
+  });
+  d_buf = std::make_shared<Buffer>(isWide);
+  if (isWide)
+  {
+    d_buf->d_wide = s;
+  }
+  else
+  {
+    d_buf->d_narrow.assign(s.begin(), s.end());
+  }
+}
+
+std::vector<unsigned> String::getVec() const
+{
+  std::vector<unsigned> vec(d_size);
+  for (std::size_t i = 0; i < d_size; i++)
+  {
+    vec[i] = (*this)[i];
+  }
+  return vec;
 }
 
 int String::cmp(const String &y) const {
   if (size() != y.size()) {
     return size() < y.size() ? -1 : 1;
   }
+  if (d_buf == y.d_buf && d_start == y.d_start)
+  {
+    return 0;
+  }
   for (unsigned int i = 0; i < size(); ++i) {
-    if (d_str[i] != y.d_str[i]) {
-      unsigned cp = d_str[i];
-      unsigned cpy = y.d_str[i];
+    unsigned cp = (*this)[i];
+    unsigned cpy = y[i];
+    if (cp != cpy) {
       return cp < cpy ? -1 : 1;
     }
   }
   return 0;
 }
 
+bool String::hasWideChar() const
+{
+  if (d_buf == nullptr || !d_buf->d_isWide)
+  {
+    return false;
+  }
+  std::vector<unsigned>::const_iterator itr = d_buf->d_wide.begin() + d_start;
+  return std::any_of(
+      itr, itr + d_size, [](unsigned u) { return u > 255; });
+}
+
+void String::append(Buffer& b, const String& s)
+{
+  if (s.d_buf == nullptr)
+  {
+    return;
+  }
+  if (!b.d_isWide && !s.d_buf->d_isWide && &b != s.d_buf.get())
+  {
+    std::string::const_iterator itr = s.d_buf->d_narrow.begin() + s.d_start;
+    b.d_narrow.append(itr, itr + s.d_size);
+    return;
+  }
+  // index each character, since s may be a range of b
+  for (std::size_t i = 0; i < s.d_size; i++)
+  {
+    if (b.d_isWide)
+    {
+      b.d_wide.push_back(s[i]);
+    }
+    else
+    {
+      Assert(s[i] < 256);
+      b.d_narrow.push_back(static_cast<char>(s[i]));
+    }
+  }
+}
+
 String String::concat(const String &other) const
 {
-  std::vector<unsigned int> ret_vec(d_str);
-  ret_vec.insert(ret_vec.end(), other.d_str.begin(), other.d_str.end());
-  return String(ret_vec);
+  if (other.d_size == 0)
+  {
+    return *this;
+  }
+  if (d_size == 0)
+  {
+    return other;
+  }
+  size_t size = d_size + other.d_size;
+  // if this string ends at the end of its buffer, we append to its buffer,
+  // provided it can store the characters of other
+  if (d_start + d_size == d_buf->size()
+      && (d_buf->d_isWide || !other.hasWideChar()))
+  {
+    append(*d_buf, other);
+    return String(d_buf, d_start, size);
+  }
+  std::shared_ptr<Buffer> buf =
+      std::make_shared<Buffer>(hasWideChar() || other.hasWideChar());
+  if (buf->d_isWide)
+  {
+    buf->d_wide.reserve(size);
+  }
+  else
+  {
+    buf->d_narrow.reserve(size);
+  }
+  append(*buf, *this);
+  append(*buf, other);
+  return String(buf, 0, size);
 }
 
 void String::addCharToInternal(unsigned char ch, std::vector<unsigned>& str)
@@ -197,17 +326,18 @@ std::vector<unsigned> String::toInternal(const std::string& s,
 std::string String::toString(bool useEscSequences) const {
   std::stringstream str;
   for (unsigned int i = 0; i < size(); ++i) {
+    unsigned c = (*this)[i];
     // we always print backslash as a code point so that it cannot be
     // interpreted as specifying part of a code point, e.g. the string '\' +
     // 'u' + '0' of length three.
-    if (isPrintable(d_str[i]) && d_str[i] != '\\' && !useEscSequences)
+    if (isPrintable(c) && c != '\\' && !useEscSequences)
     {
-      str << static_cast<char>(d_str[i]);
+      str << static_cast<char>(c);
     }
     else
     {
       std::stringstream ss;
-      ss << std::hex << d_str[i];
+      ss << std::hex << c;
       str << "\\u{" << ss.str() << "}";
     }
   }
@@ -222,8 +352,8 @@ bool String::isLeq(const String &y) const
     {
       return false;
     }
-    unsigned ci = d_str[i];
-    unsigned cyi = y.d_str[i];
+    unsigned ci = (*this)[i];
+    unsigned cyi = y[i];
     if (ci > cyi)
     {
       return false;
@@ -241,12 +371,37 @@ std::size_t String::find(const String &y, const std::size_t start) const {
   if (y.size()==0) return start;
   if (size()==0) return std::string::npos;
 
-  std::vector<unsigned>::const_iterator itr = std::search(
-      d_str.begin() + start, d_str.end(), y.d_str.begin(), y.d_str.end());
-  if (itr != d_str.end()) {
-    return itr - d_str.begin();
+  std::size_t hsize = d_size - start;
+  std::size_t pos;
+  if (!d_buf->d_isWide && !y.d_buf->d_isWide)
+  {
+    // both are byte strings, use the optimized search of the library
+    std::string_view h(d_buf->d_narrow.data() + d_start + start, hsize);
+    std::string_view n(y.d_buf->d_narrow.data() + y.d_start, y.d_size);
+    pos = h.find(n);
   }
-  return std::string::npos;
+  else if (!d_buf->d_isWide)
+  {
+    pos = findIn(getCodePoints(d_buf->d_narrow) + d_start + start,
+                 hsize,
+                 y.d_buf->d_wide.data() + y.d_start,
+                 y.d_size);
+  }
+  else if (!y.d_buf->d_isWide)
+  {
+    pos = findIn(d_buf->d_wide.data() + d_start + start,
+                 hsize,
+                 getCodePoints(y.d_buf->d_narrow) + y.d_start,
+                 y.d_size);
+  }
+  else
+  {
+    pos = findIn(d_buf->d_wide.data() + d_start + start,
+                 hsize,
+                 y.d_buf->d_wide.data() + y.d_start,
+                 y.d_size);
+  }
+  return pos == std::string::npos ? pos : pos + start;
 }
 
 std::size_t String::rfind(const String &y, const std::size_t start) const {
@@ -254,10 +409,18 @@ std::size_t String::rfind(const String &y, const std::size_t start) const {
   if (y.size()==0) return start;
   if (size()==0) return std::string::npos;
 
-  std::vector<unsigned>::const_reverse_iterator itr = std::search(
-      d_str.rbegin() + start, d_str.rend(), y.d_str.rbegin(), y.d_str.rend());
-  if (itr != d_str.rend()) {
-    return itr - d_str.rbegin();
+  // positions are counted from the end of both strings
+  for (std::size_t p = start, pend = size() - y.size(); p <= pend; p++)
+  {
+    std::size_t k = 0;
+    while (k < y.size() && (*this)[size() - 1 - p - k] == y[y.size() - 1 - k])
+    {
+      k++;
+    }
+    if (k == y.size())
+    {
+      return p;
+    }
   }
   return std::string::npos;
 }
@@ -266,19 +429,13 @@ String String::update(std::size_t i, const String& t) const
 {
   if (i < size())
   {
-    std::vector<unsigned> vec(d_str.begin(), d_str.begin() + i);
     size_t remNum = size() - i;
-    size_t tnum = t.d_str.size();
+    size_t tnum = t.size();
     if (tnum >= remNum)
     {
-      vec.insert(vec.end(), t.d_str.begin(), t.d_str.begin() + remNum);
+      return substr(0, i).concat(t.substr(0, remNum));
     }
-    else
-    {
-      vec.insert(vec.end(), t.d_str.begin(), t.d_str.end());
-      vec.insert(vec.end(), d_str.begin() + i + tnum, d_str.end());
-    }
-    return String(vec);
+    return substr(0, i).concat(t).concat(substr(i + tnum, remNum - tnum));
   }
   return *this;
 }
@@ -286,11 +443,8 @@ String String::update(std::size_t i, const String& t) const
 String String::replace(const String &s, const String &t) const {
   std::size_t ret = find(s);
   if (ret != std::string::npos) {
-    std::vector<unsigned> vec;
-    vec.insert(vec.begin(), d_str.begin(), d_str.begin() + ret);
-    vec.insert(vec.end(), t.d_str.begin(), t.d_str.end());
-    vec.insert(vec.end(), d_str.begin() + ret + s.size(), d_str.end());
-    return String(vec);
+    std::size_t rest = ret + s.size();
+    return substr(0, ret).concat(t).concat(substr(rest, size() - rest));
   } else {
     return *this;
   }
@@ -298,18 +452,19 @@ String String::replace(const String &s, const String &t) const {
 
 String String::substr(std::size_t i, std::size_t j) const {
   Assert(i + j <= size());
-  std::vector<unsigned> ret_vec;
-  std::vector<unsigned>::const_iterator itr = d_str.begin() + i;
-  ret_vec.insert(ret_vec.end(), itr, itr + j);
-  return String(ret_vec);
+  if (j == 0)
+  {
+    return String();
+  }
+  return String(d_buf, d_start + i, j);
 }
 
 bool String::isNumber() const {
-  if (d_str.empty()) {
+  if (d_size == 0) {
     return false;
   }
-  for (unsigned character : d_str) {
-    if (!isDigit(character))
+  for (std::size_t i = 0; i < d_size; i++) {
+    if (!isDigit((*this)[i]))
     {
       return false;
     }
@@ -10,6 +10,7 @@
 #define UTIL__STRING_H
 
 #include <iosfwd>
+#include <memory>
 #include <string>
 #include <vector>
 #include <cstdint>
@@ -37,8 +38,12 @@ class String
   static inline unsigned num_codes() { return 196608; }
   /** constructors for String
    *
-   * Internally, a cvc5::internal::String is represented by a vector of unsigned
-   * integers (d_str) representing the code points of the characters.
+   * Internally, a cvc5::internal::String is a range of a buffer of the code
+   * points of the characters. The buffer stores one byte per character if
+   * all of its code points are less than 256, and an unsigned per character
+   * otherwise. Buffers are shared, so that substrings are not copied, and
+   * are only appended to, so that the concatenation of a string that ends at
+   * the end of its buffer appends to that buffer instead of copying it.
    *
    * To build a string from a C++ string, we may process escape sequences
    * according to the SMT-LIB standard. In particular, if useEscSequences is
@@ -56,14 +61,16 @@ class String
    */
   String() = default;
   explicit String(const std::string& s, bool useEscSequences = false)
-      : d_str(toInternal(s, useEscSequences))
+      : String(toInternal(s, useEscSequences))
   {
   }
   explicit String(const std::vector<unsigned>& s);
 
   String& operator=(const String& y) {
     if (this != &y) {
-      d_str = y.d_str;
+      d_buf = y.d_buf;
+      d_start = y.d_start;
+      d_size = y.d_size;
     }
     return *this;
   }
@@ -87,7 +94,14 @@ class String
   /** is less than or equal to string y */
   bool isLeq(const String& y) const;
   /** Return the length of the string */
-  std::size_t size() const { return d_str.size(); }
+  std::size_t size() const { return d_size; }
+  /** Return the code point of the character at index i */
+  unsigned operator[](std::size_t i) const
+  {
+    return d_buf->d_isWide
+               ? d_buf->d_wide[d_start + i]
+               : static_cast<unsigned char>(d_buf->d_narrow[d_start + i]);
+  }
 
   /**
    * Return the first position y occurs in this string, or std::string::npos
@@ -114,7 +128,7 @@ class String
    */
   bool isNumber() const;
   /** Get the unsigned representation (code points) of this string */
-  const std::vector<unsigned>& getVec() const { return d_str; }
+  std::vector<unsigned> getVec() const;
   /** is the unsigned a digit?
    *
    * This is true for code points between 48 ('0') and 57 ('9').
@@ -134,19 +148,47 @@ class String
 
   /**
    * Returns the maximum length of string representable by this class.
-   * Corresponds to the maximum size of d_str.
+   * Corresponds to the maximum length of a string.
    */
   static size_t maxSize();
   /** Hash function */
   size_t hash() const
   {
-    std::size_t seed = d_str.size();
-    for(auto& i : d_str) {
-      seed ^= i + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+    std::size_t seed = d_size;
+    for (std::size_t i = 0; i < d_size; i++)
+    {
+      seed ^= (*this)[i] + 0x9e3779b9 + (seed << 6) + (seed >> 2);
     }
     return seed;
   }
  private:
+  /** A buffer of code points, which is only appended to */
+  struct Buffer
+  {
+    Buffer(bool isWide) : d_isWide(isWide) {}
+    /** The number of code points */
+    std::size_t size() const
+    {
+      return d_isWide ? d_wide.size() : d_narrow.size();
+    }
+    /** Whether the code points are stored in d_wide */
+    bool d_isWide;
+    /** The code points, if all of them are less than 256 */
+    std::string d_narrow;
+    /** The code points, otherwise */
+    std::vector<unsigned> d_wide;
+  };
+  /** Constructs the string for range [start, start+size) of buffer buf */
+  String(const std::shared_ptr<Buffer>& buf,
+         std::size_t start,
+         std::size_t size)
+      : d_buf(buf), d_start(start), d_size(size)
+  {
+  }
+  /** Does this string have a character whose code point is at least 256? */
+  bool hasWideChar() const;
+  /** Append the code points of s to the buffer b */
+  static void append(Buffer& b, const String& s);
   /**
    * Helper for toInternal: add character ch to vector vec, storing a string in
    * internal format. This throws an error if ch is not a printable character,
@@ -166,8 +208,12 @@ class String
    * positive number if *this > y.
    */
   int cmp(const String& y) const;
-  /** The data */
-  std::vector<unsigned> d_str;
+  /** The buffer, which is null for strings that are created empty */
+  std::shared_ptr<Buffer> d_buf;
+  /** The index of the first character of this string in d_buf */
+  std::size_t d_start = 0;
+  /** The length of this string */
+  std::size_t d_size = 0;
 };
 
 std::ostream& operator<<(std::ostream& os, const String& s);
@@ -0,0 +1,40 @@
+/******************************************************************************
+ * This file is part of the ethos project.
+ *
+ * Copyright (c) 2023-2024 by the authors listed in the file AUTHORS
+ * in the top-level source directory and their institutional affiliations.
+ * All rights reserved.  See the file COPYING in the top-level source
+ * directory for licensing information.
+ ******************************************************************************/
+/**
+ * A plugin for testing --plugin, which counts the symbols bound and prints
+ * the count when finalized.
+ */
+
+#include <iostream>
+
+#include "plugin.h"
+
+namespace ethos {
+
+class TestPlugin : public Plugin
+{
+ public:
+  TestPlugin() : d_nbind(0) {}
+  void bind(const std::string& name, const Expr& e) override { d_nbind++; }
+  void finalize() override
+  {
+    std::cout << "plugin: bound " << d_nbind << " symbols" << std::endl;
+  }
+
+ private:
+  /** The number of symbols bound */
+  size_t d_nbind;
+};
+
+}  // namespace ethos
+
+extern "C" ethos::Plugin* ethos_create_plugin(ethos::State& s)
+{
+  return new ethos::TestPlugin;
+}